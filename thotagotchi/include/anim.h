@@ -0,0 +1,70 @@
+// Keyframe animation clips for the pet and the ball.
+// A clip is a const table of keys; each key sets an offset,
+// a frame index, a draw scale and a palette entry, and says how to ease
+// towards the next key. A player runs one clip, can cross-fade into a
+// new one, and holds one queued clip to start when a one-shot ends.
+// All maths is integer: easing curves are Q8 lookup tables.
+#ifndef ANIM_H
+#define ANIM_H
+
+#include <Arduino.h>
+
+enum AnimEase : uint8_t { EASE_STEP, EASE_LINEAR, EASE_IN, EASE_OUT, EASE_IN_OUT };
+
+struct AnimKey {
+  uint16_t t;        // ms from the start of the clip
+  int8_t   dx, dy;   // offset from the entity's position, px
+  uint8_t  frame;    // index into the entity's frame table
+  uint8_t  scale;    // draw scale, 0 = the entity's default
+  uint8_t  palette;  // index into animPalette[]
+  uint8_t  ease;     // AnimEase from this key to the next
+  uint8_t  cue;      // fired when the key is reached, 0 = none
+};
+
+struct AnimClip {
+  const AnimKey *keys;
+  uint8_t  count;
+  uint16_t length;   // ms; a looping clip eases from its last key back to key 0
+  bool     loop;
+};
+
+// Sampled result the renderer reads
+struct AnimPose {
+  int16_t dx, dy;
+  uint8_t frame, scale, palette;
+};
+
+typedef void (*AnimCueFn)(uint8_t cue);
+
+struct AnimPlayer {
+  const AnimClip *clip;
+  uint16_t t;          // ms into clip
+  uint8_t  key;        // key segment t falls in
+  bool     paused;
+
+  const AnimClip *queued;      // starts when a one-shot clip ends
+  uint16_t queuedBlendMs;
+
+  AnimPose from;               // pose we are blending away from
+  uint16_t blendMs, blendT;
+
+  AnimPose  pose;              // output
+  AnimCueFn onCue;
+};
+
+extern const uint16_t animPalette[];
+
+// Players are updated by animUpdateAll() once registered
+void animRegister(AnimPlayer &p, AnimCueFn onCue);
+
+// Switch to clip now, cross-fading offsets over blendMs. No-op if the
+// clip is already playing.
+void animPlay(AnimPlayer &p, const AnimClip *clip, uint16_t blendMs);
+
+// Start clip when the current one-shot finishes (or now, if looping)
+void animQueue(AnimPlayer &p, const AnimClip *clip, uint16_t blendMs);
+
+// Advance every registered, unpaused player by dtMs. O(active players).
+void animUpdateAll(uint16_t dtMs);
+
+#endif // ANIM_H
@@ -0,0 +1,113 @@
+// Pixel-exact collision between 1-bpp masks.
+// A mask holds one bit per pixel, 32 columns to a word, MSB first (the
+// same order as the sprite bitmaps). A test rejects on the bounding boxes
+// first, then ANDs each row of one mask with the other's row shifted into
+// line, one 32-bit word at a time. Masks are built at compile time from
+// the compiled sprites, already scaled, so nothing is scaled per test.
+// Every row of a mask is one solid span (or empty); masksContact() relies
+// on that, and the builders below only make such masks.
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <stdint.h>
+#include "sprite_compiler.h"
+
+struct CollisionMask {
+  uint8_t width, height;
+  uint8_t words;             // uint32_t words per row
+  const uint32_t *rows;      // height * words
+};
+
+template <int W, int H>
+struct MaskData {
+  static constexpr int words = (W + 31) / 32;
+  uint32_t rows[H * words];
+
+  constexpr CollisionMask mask() const {
+    return CollisionMask{W, H, words, rows};
+  }
+};
+
+// Where two masks touch
+struct Contact {
+  int16_t x, y;              // centroid of the overlapping pixels
+  uint16_t pixels;           // how many pixels overlap
+  float nx, ny;              // unit normal, from the contact towards b
+};
+
+namespace collision {
+
+template <int W, int H>
+constexpr void setSpan(MaskData<W, H> &m, int y, int x0, int x1) {
+  for (int x = x0; x <= x1; x++)
+    m.rows[y * m.words + (x >> 5)] |= 0x80000000u >> (x & 31);
+}
+
+// Sprite silhouette at `scale`: each row is filled between its first and
+// last ink pixel, so gaps inside the outline (eyes, mouth) count as solid.
+template <int W, int H>
+constexpr MaskData<W, H> spriteMask(const SpriteView &s, int scale) {
+  MaskData<W, H> m{};
+  for (int y = 0; y < s.height && y * scale < H; y++) {
+    if (s.rowMinX[y] > s.rowMaxX[y]) continue;
+    for (int sy = 0; sy < scale && y * scale + sy < H; sy++)
+      setSpan(m, y * scale + sy, s.rowMinX[y] * scale,
+              (s.rowMaxX[y] + 1) * scale - 1 < W ? (s.rowMaxX[y] + 1) * scale - 1 : W - 1);
+  }
+  return m;
+}
+
+// Disc of radius r in a (2r+1)-square box, walked the same way as
+// TFT_eSPI::fillCircle() so it covers exactly the pixels that get drawn.
+template <int D>
+constexpr MaskData<D, D> circleMask() {
+  MaskData<D, D> m{};
+  int r = D / 2, c = D / 2;
+  int x = 0, dx = 1, dy = r + r, p = -(r >> 1);
+  setSpan(m, c, c - r, c + r);
+  while (x < r) {
+    if (p >= 0) {
+      setSpan(m, c + r, c - x, c - x + dx - 1);
+      setSpan(m, c - r, c - x, c - x + dx - 1);
+      dy -= 2;
+      p -= dy;
+      r--;
+    }
+    dx += 2;
+    p += dx;
+    x++;
+    setSpan(m, c + x, c - r, c - r + dy);
+    setSpan(m, c - x, c - r, c - r + dy);
+  }
+  return m;
+}
+
+}  // namespace collision
+
+// Row tests, for masks whose boxes overlap; use the wrappers below
+bool maskRowsOverlap(const CollisionMask &a, int ax, int ay,
+                     const CollisionMask &b, int bx, int by);
+bool maskRowsContact(const CollisionMask &a, int ax, int ay,
+                     const CollisionMask &b, int bx, int by, Contact &c);
+
+// Inline so the common miss costs a few compares and no call
+inline bool boxesOverlap(const CollisionMask &a, int ax, int ay,
+                         const CollisionMask &b, int bx, int by) {
+  // & rather than &&: one branch on the result instead of four
+  return (ax < bx + b.width) & (bx < ax + a.width) &
+         (ay < by + b.height) & (by < ay + a.height);
+}
+
+// True if any set pixel of a at (ax, ay) lies on a set pixel of b at (bx, by).
+inline bool masksOverlap(const CollisionMask &a, int ax, int ay,
+                         const CollisionMask &b, int bx, int by) {
+  return boxesOverlap(a, ax, ay, b, bx, by) && maskRowsOverlap(a, ax, ay, b, bx, by);
+}
+
+// As masksOverlap(), and on a hit fills in where the masks touch.
+inline bool masksContact(const CollisionMask &a, int ax, int ay,
+                         const CollisionMask &b, int bx, int by, Contact &c) {
+  return boxesOverlap(a, ax, ay, b, bx, by) && maskRowsContact(a, ax, ay, b, bx, by, c);
+}
+
+#endif // COLLISION_H
@@ -0,0 +1,72 @@
+// Bitmap drawing shared by the firmware and the host display model.
+// Include after <Arduino.h> (or the host shims) for pgm_read_byte().
+#ifndef DRAW_BITMAP_H
+#define DRAW_BITMAP_H
+
+#include "sprite_compiler.h"
+
+//------------------------------------------------------------------
+// Universal 1-bpp scaler: works with TFT_eSPI *and* TFT_eSprite
+//------------------------------------------------------------------
+template <class GFX>     // GFX = TFT_eSPI or TFT_eSprite
+void drawScaledBitmap1bpp(
+        GFX           &dst,            // where to draw (screen or sprite)
+        const uint8_t *bitmap,         // PROGMEM 1-bpp image
+        int            X,  int Y,      // top-left unless centered*
+        int            Width, 
+        int            Height,
+        int            Scale,          // integer ≥1
+        uint16_t       fgColor,
+        uint16_t       bgColor,
+        bool           transparentBg = true,
+        bool           centeredX      = false,
+        bool           centeredY      = false
+  ) {
+    if (centeredX) X = (dst.width()  - Width  * Scale) >> 1;
+    if (centeredY) Y = (dst.height() - Height * Scale) >> 1;
+
+    const int rowBytes = (Width + 7) >> 3;
+
+    for (int row = 0; row < Height; ++row) {
+        for (int col = 0; col < Width; ++col) {
+            int byteIdx = row * rowBytes + (col >> 3);
+            uint8_t  mask = 0x80 >> (col & 7);
+            bool bitOn = pgm_read_byte(&bitmap[byteIdx]) & mask;
+
+            if (bitOn || !transparentBg) {
+                uint16_t c = bitOn ? fgColor : bgColor;
+                int x0 = X + col * Scale;
+                int y0 = Y + row * Scale;
+                if (Scale == 1) dst.drawPixel(x0, y0, c);
+                else            dst.fillRect(x0, y0, Scale, Scale, c);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------
+// Run-based draw of a compiled sprite (see sprite_compiler.h): one
+// fillRect per horizontal run of ink instead of one per pixel, and
+// only the rows inside the sprite's bounds. Transparent background.
+//------------------------------------------------------------------
+template <class GFX>
+void drawSprite(
+        GFX              &dst,
+        const SpriteView &s,
+        int               X,  int Y,   // top-left unless centered*
+        int               Scale,       // integer ≥1
+        uint16_t          color,
+        bool              centeredX = false,
+        bool              centeredY = false
+  ) {
+    if (centeredX) X = (dst.width()  - s.width  * Scale) >> 1;
+    if (centeredY) Y = (dst.height() - s.height * Scale) >> 1;
+
+    for (int row = s.top; row <= s.bottom; ++row) {
+        int y0 = Y + row * Scale;
+        for (int r = s.rowRuns[row]; r < s.rowRuns[row + 1]; ++r)
+            dst.fillRect(X + s.runX[r] * Scale, y0, s.runLen[r] * Scale, Scale, color);
+    }
+}
+
+#endif // DRAW_BITMAP_H
@@ -0,0 +1,59 @@
+// Data-driven vitals, poop and death rules.
+// advanceGame() moves the game forward by any elapsed time in constant
+// time, giving the same result as running every game tick and poop check
+// one at a time. The closed forms rely on the rules pushing the pet
+// towards death: hunger only rises per tick and happiness only falls.
+#ifndef GAME_RULES_H
+#define GAME_RULES_H
+
+#include <Arduino.h>
+
+struct VitalRule {
+  int perTick;    // change applied every game tick
+  int lo, hi;     // saturation limits
+};
+
+struct GameRules {
+  VitalRule hunger;
+  VitalRule happiness;
+
+  // a tick with hunger >= deathHunger and happiness <= deathHappiness is
+  // a bad tick; deathThreshold bad ticks in a row kill the pet
+  int deathHunger;
+  int deathHappiness;
+  int deathThreshold;
+
+  // a poop check spawns a poop when any of these hold
+  int poopHungerAbove;
+  int poopHappinessBelow;
+  int poopHungerBelow;
+
+  unsigned long tickMs;
+  unsigned long poopCheckMs;
+};
+
+struct VitalState {
+  int  hunger;
+  int  happiness;
+  int  badTicks;
+  bool dead;
+};
+
+// Time already accumulated towards the next tick / poop check.
+struct RuleClock {
+  unsigned long tickPhaseMs;
+  unsigned long poopPhaseMs;
+};
+
+struct RuleOutcome {
+  unsigned long ticks;    // game ticks applied
+  unsigned long poops;    // poop checks that asked for a poop
+  bool died;              // the pet died during this advance
+};
+
+// Apply elapsedMs worth of rules to v. With decayPaused the vitals hold
+// still but the clocks, death streak and poop checks keep running.
+RuleOutcome advanceGame(const GameRules &r, VitalState &v, RuleClock &clock,
+                        unsigned long elapsedMs, bool decayPaused);
+
+#endif // GAME_RULES_H
@@ -0,0 +1,55 @@
+// Frame-budget governor. loop() reports the cost of every rendered frame
+// (game logic, then drawUI with the push). When frames run over budget
+// the quality level steps down one knob at a time, and it steps back up
+// once there is clear headroom again. Frames that ran blocking UI (tones,
+// the history screen, the death scene) are left out.
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+#include <Arduino.h>
+
+const uint32_t FRAME_BUDGET_US = 33000;     // ~30 fps
+
+// Each level keeps every cut of the levels before it
+enum QualityLevel {
+  QUALITY_FULL = 0,
+  QUALITY_PLAIN_BALL,       // beach ball without its spinning slices
+  QUALITY_FEW_PARTICLES,    // particle budget cut to a quarter
+  QUALITY_NO_AMBIENT,       // no stink lines; event effects only
+  QUALITY_HALF_RATE,        // render every other budget period (~15 fps)
+  QUALITY_LEVELS
+};
+
+struct GovernorStats {
+  uint8_t  level;           // current QualityLevel
+  uint8_t  peakLevel;
+  uint32_t frames;
+  uint32_t misses;          // frames over their level's budget
+  uint32_t skipped;         // frames left out for blocking UI
+  uint32_t stepDowns;
+  uint32_t stepUps;
+  uint32_t avgFrameUs;      // smoothed frame cost
+  uint32_t lastFrameUs;     // lastSimUs + lastDrawUs
+  uint32_t lastSimUs;
+  uint32_t lastDrawUs;
+};
+
+extern GovernorStats governorStats;
+
+// Feed one rendered frame's cost; returns true when the level changed.
+bool governorFrame(uint32_t simUs, uint32_t drawUs);
+
+// The next frame's cost includes blocking UI; don't count it.
+void governorSkipFrame();
+
+// Frame period at a level: FRAME_BUDGET_US, doubled at QUALITY_HALF_RATE.
+uint32_t governorBudgetUs(int level);
+inline uint32_t governorBudgetUs() {
+  return governorBudgetUs(governorStats.level);
+}
+
+inline bool qualityAtLeast(QualityLevel l) {
+  return governorStats.level >= l;
+}
+
+#endif // GOVERNOR_H
@@ -0,0 +1,49 @@
+// Vitals history: one hunger/happiness sample per game tick, delta
+// encoded into a bit-packed ring of fixed-size blocks kept in RTC slow
+// memory, so it survives deep sleep. Long stretches where the vitals
+// change by the same amount every tick collapse into one run token, so
+// days of history fit in a few KB. Each block starts with a keyframe
+// and decodes on its own; when the ring is full the oldest block goes.
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include "game_rules.h"
+
+const int HISTORY_BLOCK_BYTES = 128;
+const int HISTORY_BLOCKS = 32;              // 4 KB of blocks
+const unsigned long HISTORY_SAVE_EVERY = 720;   // samples (1 h) between flash saves
+
+struct HistoryStats {
+  uint32_t samples;        // samples currently held
+  uint32_t footprint;      // bytes of RAM the store takes
+  uint32_t bytesUsed;      // bytes of block payload written
+  uint32_t renderUs;       // last historyDrawGraph()
+};
+
+extern HistoryStats historyStats;
+
+// Keep the RTC copy if it survived, else load the flash copy, else
+// start empty from the given vitals.
+void historyInit(int hunger, int happiness);
+
+// Append one sample.
+void historyRecord(int hunger, int happiness);
+
+// Append the samples for `ticks` game ticks run by the rules from the
+// given starting vitals, without stepping through them one by one.
+void historyRecordTicks(const GameRules &r, int hunger, int happiness,
+                        unsigned long ticks, bool decayPaused);
+
+// Write the ring to flash if HISTORY_SAVE_EVERY samples have been added
+// since the last save, or always with force.
+void historySave(bool force);
+
+// Plot the whole history across a w x h sprite in a single decode pass.
+void historyDrawGraph(TFT_eSprite &dst, int w, int h);
+
+// Refresh and return the sample/footprint numbers.
+const HistoryStats &historyGetStats();
+
+#endif // HISTORY_H
@@ -0,0 +1,32 @@
+// Two-layer compositor for the 8-bit play field.
+// Static art (poops, the grave) is rendered once into a background
+// buffer. Each frame only the rectangles the dynamic layer drew into
+// last frame are copied back from it, instead of clearing the whole
+// sprite and re-plotting everything.
+#ifndef LAYERS_H
+#define LAYERS_H
+
+#include <Arduino.h>
+
+struct LayerStats {
+  uint32_t restoreUs;      // last layersRestore()
+  uint32_t restoredPx;     // pixels copied by it
+  uint16_t rects;          // rectangles it restored
+  uint32_t rebuilds;       // full background copies so far
+};
+
+extern LayerStats layerStats;
+
+// bg and fg are w x h RGB332 buffers (sprite pointers)
+void layersInit(uint8_t *bg, uint8_t *fg, int w, int h);
+
+// Record a rectangle the dynamic layer is about to draw into
+void layersMarkDirty(int x, int y, int w, int h);
+
+// Copy the background over everything marked since the last restore
+void layersRestore();
+
+// Copy the whole background, e.g. after it was re-rendered
+void layersRestoreAll();
+
+#endif // LAYERS_H
@@ -0,0 +1,131 @@
+// Binary control and telemetry link over the USB UART, for test rigs.
+// Build with -DTHOT_SERIAL_LINK (see [env:esp32dev-link]); otherwise
+// none of this is compiled. tools/thotlink.py is the host side.
+//
+// Frame:  A5 | len | type | payload[len] | crc16 lo | crc16 hi
+// The CRC is CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over len,
+// type and payload. Payload structs are packed little-endian.
+#ifndef LINK_H
+#define LINK_H
+
+#include <Arduino.h>
+
+#ifdef THOT_SERIAL_LINK
+
+#ifdef THOT_TRACE
+#error "THOT_SERIAL_LINK and THOT_TRACE both want the serial port"
+#endif
+
+const uint32_t LINK_BAUD = 921600;
+const uint8_t  LINK_SYNC = 0xA5;
+const int      LINK_MAX_PAYLOAD = 64;
+const int      LINK_TX_BUFFER = 4096;    // UART driver ring, drained by its ISR
+
+enum LinkType : uint8_t {
+  // host -> badge
+  LINK_PING      = 0x01,   // any payload, echoed back in LINK_PONG
+  LINK_WHEEL     = 0x10,   // LinkWheel
+  LINK_CENTER    = 0x11,   // LinkCenter
+  LINK_SET_STATE = 0x12,   // LinkSetState
+  LINK_WARP      = 0x13,   // LinkWarp
+  LINK_ACTION    = 0x14,   // LinkAction
+  LINK_STREAM    = 0x15,   // LinkStream
+  // badge -> host
+  LINK_PONG      = 0x81,
+  LINK_ACK       = 0x82,   // LinkAck, after every command
+  LINK_STATE     = 0x90,   // LinkState
+  LINK_FRAME     = 0x91,   // LinkFrameTiming
+};
+
+// LinkSetState / LinkState flags
+const uint8_t LINK_FLAG_DEAD    = 0x01;
+const uint8_t LINK_FLAG_DVD     = 0x02;   // DVD bounce movement
+const uint8_t LINK_FLAG_EATING  = 0x04;   // state only
+const uint8_t LINK_FLAG_PLAYING = 0x08;   // state only
+const uint8_t LINK_FLAG_FOOD    = 0x10;   // state only
+
+// LinkStream mask
+const uint8_t LINK_STREAM_STATE  = 0x01;
+const uint8_t LINK_STREAM_FRAMES = 0x02;
+
+struct __attribute__((packed)) LinkWheel {
+  int16_t angle;          // degrees 0..359, negative lifts the finger
+};
+
+struct __attribute__((packed)) LinkCenter {
+  uint8_t pressed;        // held until told otherwise
+};
+
+struct __attribute__((packed)) LinkSetState {
+  uint8_t hunger, happiness, badTicks;
+  uint8_t flags;          // LINK_FLAG_DEAD / LINK_FLAG_DVD; no DEAD revives
+  uint8_t poops;          // replace all poops with this many at random spots
+};
+
+struct __attribute__((packed)) LinkWarp {
+  uint32_t ms;            // run the rules forward this far
+};
+
+struct __attribute__((packed)) LinkAction {
+  uint8_t menu;           // 0 feed, 1 play, 2 clean
+};
+
+struct __attribute__((packed)) LinkStream {
+  uint8_t  mask;          // LINK_STREAM_*
+  uint16_t statePeriodMs; // 0: state only after commands
+};
+
+struct __attribute__((packed)) LinkAck {
+  uint8_t type;           // command being answered
+  uint8_t ok;
+};
+
+struct __attribute__((packed)) LinkState {
+  uint32_t ms;
+  uint8_t  hunger, happiness, badTicks, flags;
+  uint8_t  petX, petY, poops, menu;
+  uint16_t rxBad;         // frames dropped for bad length / CRC
+  uint16_t txDropped;     // frames dropped because the TX ring was full
+};
+
+struct __attribute__((packed)) LinkFrameTiming {
+  uint32_t frame;         // frames rendered
+  uint32_t simUs;         // loop() work before drawUI()
+  uint32_t drawUs;        // drawUI(), push included
+  uint16_t restoreUs;     // background restore inside it
+  uint16_t particles;     // live particles
+  uint8_t  quality;       // governor QualityLevel
+  uint32_t misses;        // frames over budget so far
+  uint16_t planUs;        // pathfinding over all loop() passes of the frame
+  uint16_t expansions;    // A* nodes expanded in that time
+  uint16_t particleUpdateUs;  // particle steps over the frame's loop() passes
+  uint16_t particleDrawUs;    // particle plotting inside drawUs
+};
+
+struct LinkStats {
+  uint32_t rxFrames;
+  uint32_t rxBad;
+  uint32_t txFrames;
+  uint32_t txDropped;
+};
+
+typedef void (*LinkHandler)(uint8_t type, const uint8_t *payload, uint8_t len);
+
+extern LinkStats linkStats;
+
+// Open the UART at LINK_BAUD; handler runs from linkService() for every
+// frame that passes the CRC.
+void linkBegin(LinkHandler handler);
+
+// Parse whatever has arrived. Call once each loop().
+void linkService();
+
+// Queue one frame without blocking. If the TX ring has no room for all
+// of it the frame is dropped, counted, and false returned.
+bool linkSend(uint8_t type, const void *payload, uint8_t len);
+
+uint16_t linkCrc16(const uint8_t *data, size_t len, uint16_t crc = 0xFFFF);
+
+#endif // THOT_SERIAL_LINK
+
+#endif // LINK_H
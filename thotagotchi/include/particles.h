@@ -0,0 +1,63 @@
+// Fixed-capacity particle system for small effects.
+// Storage is structure-of-arrays in Q4 fixed point; updates run as one
+// batch and drawing is a single loop that writes RGB332 pixels straight
+// into an 8-bit sprite buffer (petLayer).
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <Arduino.h>
+
+const int MAX_PARTICLES = 256;
+const int PARTICLE_GROUPS = 6;       // dirty boxes reported by particlesBounds()
+
+// RGB332 colours, as TFT_eSprite::color16to8() would give them
+const uint8_t PCOL_WHITE  = 0xFF;
+const uint8_t PCOL_RED    = 0xE0;
+const uint8_t PCOL_PINK   = 0xFB;
+const uint8_t PCOL_ORANGE = 0xF4;
+const uint8_t PCOL_YELLOW = 0xFC;
+const uint8_t PCOL_GREEN  = 0x1C;
+const uint8_t PCOL_BLUE   = 0x03;
+const uint8_t PCOL_BROWN  = 0x88;
+const uint8_t PCOL_OLIVE  = 0x6C;
+const uint8_t PCOL_GREY   = 0xDB;
+
+struct ParticleStats {
+  uint16_t live;
+  uint16_t peak;
+  uint32_t dropped;      // emits refused because the pool or budget was full
+  uint32_t updateUs;     // particlesUpdate() over the last rendered frame
+  uint32_t drawUs;       // last particlesDraw()
+};
+
+extern ParticleStats particleStats;
+
+// Cap on live particles, at most MAX_PARTICLES (the frame governor lowers it)
+void particlesSetBudget(int maxLive);
+
+// Emitters, positions in sprite pixels
+void particlesEmitCrumbs(int x, int y);
+void particlesEmitHearts(int x, int y);
+void particlesEmitConfetti(int x, int y);
+void particlesEmitStink(int x, int y);
+void particlesEmitDust(int x, int y, int dirX, int dirY);
+
+// Step the simulation; runs whole 32 ms steps from the elapsed time
+void particlesUpdate(unsigned long dtMs);
+
+// Call once per rendered frame; closes the update time of the loop()
+// passes since the last one into particleStats.updateUs
+void particlesFrameDone();
+
+// Plot every live particle into an 8-bit w x h buffer
+void particlesDraw(uint8_t *buf, int w, int h);
+
+// Bounding boxes of the live particles, one per group of bursts emitted
+// near each other, so stink over poops in opposite corners doesn't dirty
+// the whole field. Fills up to PARTICLE_GROUPS boxes and returns how many.
+struct ParticleBox {
+  int16_t x0, y0, x1, y1;    // x1/y1 exclusive
+};
+int particlesBounds(ParticleBox *boxes);
+
+#endif // PARTICLES_H
@@ -0,0 +1,60 @@
+// Behaviour and pathfinding for the pet.
+// A utility-scored behaviour picks a goal; an incremental A* planner over a
+// coarse grid of pet positions finds a route around poops. Planning is
+// time-sliced: petAiPlan() resumes the search under a microsecond budget
+// and the finished path is cached until the goal or the world changes.
+#ifndef PET_AI_H
+#define PET_AI_H
+
+#include <Arduino.h>
+
+const int AI_CELL = 8;            // grid pitch in sprite pixels
+
+enum PetBehavior { BEHAVE_WANDER, BEHAVE_REST, BEHAVE_SEEK_FOOD, BEHAVE_CHASE_BALL };
+
+// What the pet can see; filled in by movePet() every move step.
+struct PetSenses {
+  int  petX, petY;              // top-left of the pet
+  bool foodVisible;
+  int  foodX, foodY;            // top-left pet position that reaches the food
+  bool ballInPlay;
+  int  ballX, ballY;            // top-left pet position that reaches the ball
+  int  happiness;
+};
+
+struct PetAiStats {
+  uint32_t planUsLastFrame;     // petAiPlan() time over the last rendered frame
+  uint32_t planUsMax;           // worst rendered frame so far
+  uint16_t expansionsLastFrame;
+  uint32_t searchesStarted;
+  uint32_t searchesCompleted;
+  uint32_t cacheHits;           // goal requests served by the cached path
+};
+
+extern PetAiStats petAiStats;
+
+// Size of the field the pet's top-left corner can occupy, and of the pet.
+void petAiInit(int fieldW, int fieldH, int petW, int petH);
+
+// Call once per rendered frame. petAiPlan() runs on every loop() pass,
+// several per frame; this closes the frame's totals into petAiStats.
+void petAiFrameDone();
+
+// Obstacles are rebuilt as a batch; finishing the batch invalidates paths.
+// A cell is penalised when the middle half of the pet, standing with its
+// top-left corner there, overlaps the obstacle rect.
+void petAiClearObstacles();
+void petAiAddObstacle(int x, int y, int w, int h);
+void petAiObstaclesDone();
+
+// Scores the behaviours, switches if another one wins and updates the goal.
+PetBehavior petAiThink(const PetSenses &s, unsigned long now);
+
+// Resume the current search for at most budgetUs. Call once per loop().
+void petAiPlan(unsigned long budgetUs);
+
+// Advance x/y by up to stepPx along the cached path. Returns false when no
+// path is ready yet (caller decides on a fallback) or the pet is resting.
+bool petAiStep(int &x, int &y, int stepPx);
+
+#endif // PET_AI_H
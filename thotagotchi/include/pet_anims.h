@@ -0,0 +1,57 @@
+// Animation clips for the pet and the beach ball (see anim.h).
+// Pet frames index petFrames[] in main.cpp: 0 happy, 1 sad, 2 dead.
+#ifndef PET_ANIMS_H
+#define PET_ANIMS_H
+
+#include "anim.h"
+
+// Cues fired by clip keys, handled by onPetCue() in main.cpp
+enum PetCue : uint8_t { CUE_NONE, CUE_CHOMP_HIGH, CUE_CHOMP_LOW, CUE_CHEER };
+
+//                                t    dx  dy  frm scl pal  ease         cue
+const AnimKey idleHappyKeys[] = {{   0, 0,  0,  0,  0,  0, EASE_IN_OUT, CUE_NONE},
+                                 { 600, 0, -2,  0,  0,  0, EASE_IN_OUT, CUE_NONE}};
+const AnimClip clipIdleHappy = {idleHappyKeys, 2, 1200, true};
+
+const AnimKey idleSadKeys[] =   {{   0, 0,  0,  1,  0,  0, EASE_IN_OUT, CUE_NONE},
+                                 {1500, 0,  2,  1,  0,  1, EASE_IN_OUT, CUE_NONE}};
+const AnimClip clipIdleSad = {idleSadKeys, 2, 3000, true};
+
+// Replaces the old +-5 px bounce timer in handleEatingBounce()
+const AnimKey eatingKeys[] =    {{   0, 0, -5,  0,  0,  0, EASE_OUT,    CUE_CHOMP_HIGH},
+                                 { 200, 0,  0,  0,  0,  0, EASE_IN,     CUE_CHOMP_LOW}};
+const AnimClip clipEating = {eatingKeys, 2, 400, true};
+
+const AnimKey playingKeys[] =   {{   0, 0,  0,  0,  0,  0, EASE_OUT,    CUE_NONE},
+                                 { 150, 0, -4,  0,  0,  0, EASE_IN,     CUE_NONE}};
+const AnimClip clipPlaying = {playingKeys, 2, 300, true};
+
+// Two happy hops when play time ends
+const AnimKey cheerKeys[] =     {{   0, 0,  0,  0,  0,  0, EASE_OUT,    CUE_CHEER},
+                                 { 150, 0, -8,  0,  0,  0, EASE_IN,     CUE_NONE},
+                                 { 300, 0,  0,  0,  0,  0, EASE_OUT,    CUE_CHEER},
+                                 { 450, 0, -8,  0,  0,  0, EASE_IN,     CUE_NONE},
+                                 { 600, 0,  0,  0,  0,  0, EASE_STEP,   CUE_NONE}};
+const AnimClip clipCheer = {cheerKeys, 5, 600, false};
+
+// Sink and fade before the grave appears
+const AnimKey dyingKeys[] =     {{   0, 0,  0,  2,  0,  0, EASE_LINEAR, CUE_NONE},
+                                 { 400, 0,  3,  2,  0,  1, EASE_LINEAR, CUE_NONE},
+                                 { 800, 0,  6,  2,  0,  2, EASE_STEP,   CUE_NONE}};
+const AnimClip clipDying = {dyingKeys, 3, 1000, false};
+
+// Beach ball: frame n = slices turned n * 30 degrees, one step per move
+const AnimKey ballSpinKeys[] = {
+  {   0, 0, 0,  0, 0, 0, EASE_STEP, CUE_NONE}, { 200, 0, 0,  1, 0, 0, EASE_STEP, CUE_NONE},
+  { 400, 0, 0,  2, 0, 0, EASE_STEP, CUE_NONE}, { 600, 0, 0,  3, 0, 0, EASE_STEP, CUE_NONE},
+  { 800, 0, 0,  4, 0, 0, EASE_STEP, CUE_NONE}, {1000, 0, 0,  5, 0, 0, EASE_STEP, CUE_NONE},
+  {1200, 0, 0,  6, 0, 0, EASE_STEP, CUE_NONE}, {1400, 0, 0,  7, 0, 0, EASE_STEP, CUE_NONE},
+  {1600, 0, 0,  8, 0, 0, EASE_STEP, CUE_NONE}, {1800, 0, 0,  9, 0, 0, EASE_STEP, CUE_NONE},
+  {2000, 0, 0, 10, 0, 0, EASE_STEP, CUE_NONE}, {2200, 0, 0, 11, 0, 0, EASE_STEP, CUE_NONE}};
+const AnimClip clipBallSpin = {ballSpinKeys, 12, 2400, true};
+
+// Slice centre offsets for each spin frame, r/2 = 6 px at 30 degree steps
+const int8_t ballSliceDX[12] = {6, 5, 3, 0, -3, -5, -6, -5, -3, 0, 3, 5};
+const int8_t ballSliceDY[12] = {0, 3, 5, 6, 5, 3, 0, -3, -5, -6, -5, -3};
+
+#endif // PET_ANIMS_H
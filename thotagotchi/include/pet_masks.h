@@ -0,0 +1,20 @@
+// Collision masks for the game's sprites, scaled at compile time (see
+// collision.h). Shared by main.cpp and tools/collision_bench so the bench
+// measures the masks the firmware uses.
+// Include after <TFT_eSPI.h> (or display_model.h), as for ui_draw.h.
+#ifndef PET_MASKS_H
+#define PET_MASKS_H
+
+#include "collision.h"
+#include "pet_sprites.h"
+#include "ui_draw.h"
+
+// All pet faces share one outline, so the happy face stands in for them.
+constexpr auto petMaskData = collision::spriteMask<petBitmapWidth * petScale, petBitmapHeight * petScale>(pet_happy_sprite, petScale);
+constexpr auto foodMaskData = collision::spriteMask<foodW * foodScale, foodH * foodScale>(food_bitmap_sprite, foodScale);
+constexpr auto ballMaskData = collision::circleMask<ballDiameter + 1>();
+constexpr CollisionMask petMask = petMaskData.mask();
+constexpr CollisionMask foodMask = foodMaskData.mask();
+constexpr CollisionMask ballMask = ballMaskData.mask();
+
+#endif // PET_MASKS_H
@@ -1,23 +1,75 @@
-// https://easy-bitmap.online/
+// Sprite art. Each sprite is drawn as ASCII art ('#' ink, '.' blank) and
+// compiled into 1-bpp data, run lists and bounds by SPRITE_ART() at build
+// time; see sprite_compiler.h.
 #ifndef PET_SPRITES_H
 #define PET_SPRITES_H
 
+#include "sprite_compiler.h"
+
 
 const int petBitmapWidth = 16;
 const int petBitmapHeight = 16;
 const int petScale = 3;
-const uint8_t pet_happy[] PROGMEM = {
-  0x00, 0x00, 0x0f, 0xf0, 0x1e, 0x78, 0x30, 0x0c, 0x3f, 0xfc, 0x34, 0x2c, 0x62, 0x46, 0x6d, 0xb6, 0x73, 0xce, 0x6e, 0x76, 0x51, 0x8a, 0x3a, 0x5c, 0x3d, 0xbc, 0x2d, 0xb4, 0x2f, 0xf4, 0x1f, 0xf8
+constexpr const char *pet_happy_art[] = {
+  "................",
+  "....########....",
+  "...####..####...",
+  "..##........##..",
+  "..############..",
+  "..##.#....#.##..",
+  ".##...#..#...##.",
+  ".##.##.##.##.##.",
+  ".###..####..###.",
+  ".##.###..###.##.",
+  ".#.#...##...#.#.",
+  "..###.#..#.###..",
+  "..####.##.####..",
+  "..#.##.##.##.#..",
+  "..#.########.#..",
+  "...##########...",
 };
-const uint8_t pet_sad[] PROGMEM = {
-  // mouth changed
-  0x00, 0x00, 0x0f, 0xf0, 0x1e, 0x78, 0x30, 0x0c, 0x3f, 0xfc, 0x34, 0x2c, 0x62, 0x46, 0x6d, 0xb6, 0x73, 0xce, 0x6e, 0x76, 0x51, 0x8a, 0x3d, 0xbc, 0x3a, 0x5c, 0x2d, 0xb4, 0x2f, 0xf4, 0x1f, 0xf8
+SPRITE_ART(pet_happy, petBitmapWidth, petBitmapHeight, pet_happy_art);
+// mouth changed
+constexpr const char *pet_sad_art[] = {
+  "................",
+  "....########....",
+  "...####..####...",
+  "..##........##..",
+  "..############..",
+  "..##.#....#.##..",
+  ".##...#..#...##.",
+  ".##.##.##.##.##.",
+  ".###..####..###.",
+  ".##.###..###.##.",
+  ".#.#...##...#.#.",
+  "..####.##.####..",
+  "..###.#..#.###..",
+  "..#.##.##.##.#..",
+  "..#.########.#..",
+  "...##########...",
 };
-const uint8_t pet_dead[] PROGMEM = {
-  // X eyes
-  // flat mouth
-  0x00, 0x00, 0x0f, 0xf0, 0x1e, 0x78, 0x30, 0x0c, 0x3f, 0xfc, 0x34, 0x2c, 0x69, 0x96, 0x66, 0x66, 0x69, 0x96, 0x66, 0x66, 0x51, 0x8a, 0x3c, 0x3c, 0x3c, 0x3c, 0x2d, 0xb4, 0x2f, 0xf4, 0x1f, 0xf8
+SPRITE_ART(pet_sad, petBitmapWidth, petBitmapHeight, pet_sad_art);
+// X eyes
+// flat mouth
+constexpr const char *pet_dead_art[] = {
+  "................",
+  "....########....",
+  "...####..####...",
+  "..##........##..",
+  "..############..",
+  "..##.#....#.##..",
+  ".##.#..##..#.##.",
+  ".##..##..##..##.",
+  ".##.#..##..#.##.",
+  ".##..##..##..##.",
+  ".#.#...##...#.#.",
+  "..####....####..",
+  "..####....####..",
+  "..#.##.##.##.#..",
+  "..#.########.#..",
+  "...##########...",
 };
+SPRITE_ART(pet_dead, petBitmapWidth, petBitmapHeight, pet_dead_art);
 
 
 // const int poopW = 32;
@@ -31,9 +83,25 @@ const uint8_t pet_dead[] PROGMEM = {
 const int poopW = 16;
 const int poopH = 16;
 const int poopScale = 2;
-const uint8_t poop_bitmap[] PROGMEM = {
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x00, 0x20, 0x80, 0x10, 0x04, 0x20, 0x08, 0x11, 0x04, 0x03, 0x08, 0x07, 0x80, 0x04, 0xc0, 0x0f, 0xe0, 0x1c, 0x78, 0x1f, 0xf8, 0x3f, 0x0c, 0x3f, 0xfc
+constexpr const char *poop_bitmap_art[] = {
+  "................",
+  "................",
+  "........#.......",
+  ".......#........",
+  "..#.....#.......",
+  "...#.........#..",
+  "..#.........#...",
+  "...#...#.....#..",
+  "......##....#...",
+  ".....####.......",
+  ".....#..##......",
+  "....#######.....",
+  "...###...####...",
+  "...##########...",
+  "..######....##..",
+  "..############..",
 };
+SPRITE_ART(poop_bitmap, poopW, poopH, poop_bitmap_art);
   
 // alternate poop, wip
 // const uint8_t poop_bitmap[] PROGMEM = {
@@ -44,39 +112,116 @@ const uint8_t poop_bitmap[] PROGMEM = {
 const int graveW = 16;
 const int graveH = 16;
 const int graveScale = 6;
-const uint8_t grave_back_bitmap[] PROGMEM = {
-  0x0f, 0xe0, 0x1f, 0xf0, 0x3e, 0xf8, 0x7c, 0x7c, 0x7e, 0xfc, 0x7e, 0xfc, 0x7f, 0xfc, 0x7f, 0xfc, 0x7f, 0xfc, 0x7f, 0xfc, 0x7f, 0xfc, 0x7f, 0xfc, 0x7f, 0xfc, 0x7f, 0xfc, 0x7f, 0xfc, 0x7f, 0xfc
+constexpr const char *grave_back_bitmap_art[] = {
+  "....#######.....",
+  "...#########....",
+  "..#####.#####...",
+  ".#####...#####..",
+  ".######.######..",
+  ".######.######..",
+  ".#############..",
+  ".#############..",
+  ".#############..",
+  ".#############..",
+  ".#############..",
+  ".#############..",
+  ".#############..",
+  ".#############..",
+  ".#############..",
+  ".#############..",
 };
-const uint8_t grave_rip_bitmap[] PROGMEM = {
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1d, 0x70, 0x15, 0x50, 0x19, 0x70, 0x15, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+SPRITE_ART(grave_back_bitmap, graveW, graveH, grave_back_bitmap_art);
+constexpr const char *grave_rip_bitmap_art[] = {
+  "................",
+  "................",
+  "................",
+  "................",
+  "................",
+  "................",
+  "................",
+  "...###.#.###....",
+  "...#.#.#.#.#....",
+  "...##..#.###....",
+  "...#.#.#.#......",
+  "................",
+  "................",
+  "................",
+  "................",
+  "................",
 };
+SPRITE_ART(grave_rip_bitmap, graveW, graveH, grave_rip_bitmap_art);
 
 
 // Chicken Drumstick Bitmap (24x24)
 const int foodW = 24;
 const int foodH = 24;
 const int foodScale = 1;
-const uint8_t food_bitmap[] PROGMEM = {
-	0x1f, 0xe0, 0x00, 0x3f, 0xf0, 0x00, 0x7f, 0xf8, 0x00, 0x7f, 0xfc, 0x00, 0xff, 0xfc, 0x00, 0xff, 
-	0xfe, 0x00, 0xff, 0xff, 0x00, 0xff, 0xff, 0x00, 0xff, 0xff, 0x00, 0xff, 0xff, 0x00, 0x7f, 0xff, 
-	0x00, 0x7f, 0xff, 0x00, 0x3f, 0xff, 0x80, 0x1f, 0xff, 0x80, 0x0f, 0xff, 0xc0, 0x00, 0xff, 0xe0, 
-	0x00, 0x1f, 0xe0, 0x00, 0x07, 0xe0, 0x00, 0x01, 0xf0, 0x00, 0x00, 0x7f, 0x00, 0x00, 0x3f, 0x00, 
-	0x00, 0x1f, 0x00, 0x00, 0x1d, 0x00, 0x00, 0x1c
+constexpr const char *food_bitmap_art[] = {
+  "...########.............",
+  "..##########............",
+  ".############...........",
+  ".#############..........",
+  "##############..........",
+  "###############.........",
+  "################........",
+  "################........",
+  "################........",
+  "################........",
+  ".###############........",
+  ".###############........",
+  "..###############.......",
+  "...##############.......",
+  "....##############......",
+  "........###########.....",
+  "...........########.....",
+  ".............######.....",
+  "...............#####....",
+  ".................#######",
+  "..................######",
+  "...................#####",
+  "...................###.#",
+  "...................###..",
 };
+SPRITE_ART(food_bitmap, foodW, foodH, food_bitmap_art);
 
 // Tamagotchi Egg (28x32)
 const int eggW = 28;
 const int eggH = 32;
 const int eggScale = 2;
-const unsigned char egg_bitmap [] PROGMEM = {
-	0x00, 0x1f, 0x80, 0x00, 0x00, 0x7f, 0xe0, 0x00, 0x00, 0xff, 0xf0, 0x00, 0x03, 0xff, 0xf8, 0x00, 
-	0x03, 0xff, 0xfc, 0x00, 0x07, 0xff, 0xfe, 0x00, 0x0f, 0xff, 0xff, 0x00, 0x1f, 0xff, 0xff, 0x00, 
-	0x1f, 0xff, 0xff, 0x80, 0x3c, 0x00, 0x07, 0x80, 0x3c, 0x00, 0x07, 0xc0, 0x7c, 0x00, 0x07, 0xc0, 
-	0x7c, 0x00, 0x07, 0xe0, 0x7c, 0x00, 0x07, 0xe0, 0x7c, 0x00, 0x07, 0xe0, 0xfc, 0x00, 0x07, 0xe0, 
-	0xfc, 0x00, 0x07, 0xf0, 0xfc, 0x00, 0x07, 0xf0, 0xfc, 0x00, 0x07, 0xf0, 0xff, 0xff, 0xff, 0xf0, 
-	0xff, 0xff, 0xff, 0xf0, 0xff, 0x7f, 0xcf, 0xe0, 0x7e, 0x39, 0x87, 0xe0, 0x7c, 0x10, 0x87, 0xe0, 
-	0x7e, 0x30, 0x87, 0xc0, 0x3f, 0x70, 0xef, 0xc0, 0x1f, 0xf9, 0xff, 0x80, 0x0f, 0xff, 0xff, 0x00, 
-	0x07, 0xff, 0xfe, 0x00, 0x03, 0xff, 0xfc, 0x00, 0x00, 0xff, 0xf0, 0x00, 0x00, 0x3f, 0xc0, 0x00
+constexpr const char *egg_bitmap_art[] = {
+  "...........######...........",
+  ".........##########.........",
+  "........############........",
+  "......###############.......",
+  "......################......",
+  ".....##################.....",
+  "....####################....",
+  "...#####################....",
+  "...######################...",
+  "..####...............####...",
+  "..####...............#####..",
+  ".#####...............#####..",
+  ".#####...............######.",
+  ".#####...............######.",
+  ".#####...............######.",
+  "######...............######.",
+  "######...............#######",
+  "######...............#######",
+  "######...............#######",
+  "############################",
+  "############################",
+  "########.#########..#######.",
+  ".######...###..##....######.",
+  ".#####.....#....#....######.",
+  ".######...##....#....#####..",
+  "..######.###....###.######..",
+  "...##########..##########...",
+  "....####################....",
+  ".....##################.....",
+  "......################......",
+  "........############........",
+  "..........########..........",
 };
+SPRITE_ART(egg_bitmap, eggW, eggH, egg_bitmap_art);
 
 #endif // PET_SPRITES_H
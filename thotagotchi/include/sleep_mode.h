@@ -0,0 +1,50 @@
+// Deep sleep with the game kept in RTC slow memory and wake-on-touch.
+// main.cpp packs its state into rtcSave before sleepEnter() and unpacks
+// it again when sleepWokeWithSave() says this boot is a touch wake.
+#ifndef SLEEP_MODE_H
+#define SLEEP_MODE_H
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+
+const int SAVED_POOPS = 25;
+
+// Everything needed to pick the game up again, ~80 bytes
+struct SavedGame {
+  uint32_t magic;
+  uint8_t  hunger;
+  uint8_t  happiness;
+  uint8_t  badTicks;
+  uint8_t  dead      : 1;
+  uint8_t  moveMode  : 1;
+  uint8_t  petX, petY;
+  uint16_t tickPhaseMs, poopPhaseMs;
+  uint32_t poopMask;                  // bit i set: poop i active
+  uint8_t  poopX[SAVED_POOPS];
+  uint8_t  poopY[SAVED_POOPS];
+  uint16_t touchBaseline[4];          // Q2, Q1, Q3, select
+  int64_t  sleptAtUs;                 // wall clock when we went down
+};
+
+struct SleepStats {
+  uint32_t wakeToFirstFrameUs;   // boot to first pushed frame, this wake
+  uint32_t sleptMs;              // how long we were asleep
+};
+
+extern SavedGame  rtcSave;
+extern SleepStats sleepStats;
+
+// True when this boot is a touch wake from sleepEnter() with a valid save.
+bool sleepWokeWithSave();
+
+// Milliseconds spent asleep, valid after sleepWokeWithSave() returned true.
+unsigned long sleepElapsedMs();
+
+// Record boot-to-first-frame once, right after the first pushSprite().
+void sleepMarkFirstFrame();
+
+// Blank the panel, arm touch wake on the given pads and enter deep sleep.
+// Wakes when a pad reads below its threshold. Does not return.
+void sleepEnter(TFT_eSPI &tft, const int *touchPins, const uint16_t *thresholds, int count);
+
+#endif // SLEEP_MODE_H
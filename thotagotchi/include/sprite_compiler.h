@@ -0,0 +1,134 @@
+// Compile-time sprite compiler (C++17).
+// Sprites are written as ASCII art, one string literal per row, '#' for
+// ink and '.' for blank. SPRITE_ART() turns them into constexpr data in
+// flash: the packed 1-bpp rows (same layout as the old hex arrays), the
+// horizontal runs of every row, and per-row and overall bounds. Nothing
+// is parsed at runtime and nothing is copied to RAM; bad art fails the
+// build through the static_asserts in the macro.
+#ifndef SPRITE_COMPILER_H
+#define SPRITE_COMPILER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Size-independent view of a compiled sprite, so sprites of any size or
+// run count can share one draw routine and sit in one table.
+struct SpriteView {
+  uint8_t width, height;
+  uint8_t top, bottom;       // first / last row with ink (top > bottom: blank)
+  uint8_t left, right;       // first / last column with ink
+  const uint8_t *bits;       // packed 1-bpp rows, MSB first
+  const uint8_t *rowRuns;    // runs of row y are [rowRuns[y], rowRuns[y + 1])
+  const uint8_t *runX;       // first column of each run
+  const uint8_t *runLen;     // pixels in each run
+  const uint8_t *rowMinX;    // per-row ink bounds; rowMinX > rowMaxX on blank rows
+  const uint8_t *rowMaxX;
+};
+
+template <int W, int H, int R>
+struct CompiledSprite {
+  static constexpr int rowBytes = (W + 7) / 8;
+  uint8_t bits[H * rowBytes];
+  uint8_t rowRuns[H + 1];
+  uint8_t runX[R > 0 ? R : 1];
+  uint8_t runLen[R > 0 ? R : 1];
+  uint8_t rowMinX[H];
+  uint8_t rowMaxX[H];
+  uint8_t top, bottom, left, right;
+};
+
+namespace sprite_compiler {
+
+constexpr bool isInk(char c) {
+  return c == '#';
+}
+
+constexpr int rowLength(const char *row) {
+  int n = 0;
+  while (row[n]) n++;
+  return n;
+}
+
+template <size_t N>
+constexpr int rowCount(const char *const (&)[N]) {
+  return (int)N;
+}
+
+template <size_t N>
+constexpr bool rowsAreWidth(const char *const (&art)[N], int w) {
+  for (size_t y = 0; y < N; y++)
+    if (rowLength(art[y]) != w) return false;
+  return true;
+}
+
+template <size_t N>
+constexpr bool onlyArtChars(const char *const (&art)[N]) {
+  for (size_t y = 0; y < N; y++)
+    for (const char *p = art[y]; *p; p++)
+      if (*p != '#' && *p != '.') return false;
+  return true;
+}
+
+template <size_t N>
+constexpr int runCount(const char *const (&art)[N]) {
+  int runs = 0;
+  for (size_t y = 0; y < N; y++)
+    for (int x = 0; art[y][x]; x++)
+      if (isInk(art[y][x]) && (x == 0 || !isInk(art[y][x - 1]))) runs++;
+  return runs;
+}
+
+template <int W, int H, int R, size_t N>
+constexpr CompiledSprite<W, H, R> compile(const char *const (&art)[N]) {
+  static_assert(W > 0 && W < 256 && H > 0 && H < 256, "sprite size out of range");
+  static_assert(R < 256, "too many runs for 8-bit run indices");
+  CompiledSprite<W, H, R> s{};
+  s.top = H;
+  s.left = W;
+  int r = 0;
+  for (int y = 0; y < H; y++) {
+    s.rowRuns[y] = r;
+    s.rowMinX[y] = W;
+    for (int x = 0; x < W; x++) {
+      if (!isInk(art[y][x])) continue;
+      s.bits[y * s.rowBytes + (x >> 3)] |= 0x80 >> (x & 7);
+      if (x == 0 || !isInk(art[y][x - 1])) {
+        s.runX[r] = x;
+        s.runLen[r] = 0;
+        r++;
+      }
+      s.runLen[r - 1]++;
+      if (s.rowMinX[y] == W) s.rowMinX[y] = x;
+      s.rowMaxX[y] = x;
+    }
+    if (s.rowMinX[y] < W) {
+      if (s.top == H) s.top = y;
+      s.bottom = y;
+      if (s.rowMinX[y] < s.left) s.left = s.rowMinX[y];
+      if (s.rowMaxX[y] > s.right) s.right = s.rowMaxX[y];
+    }
+  }
+  s.rowRuns[H] = r;
+  return s;
+}
+
+template <int W, int H, int R>
+constexpr SpriteView view(const CompiledSprite<W, H, R> &s) {
+  return SpriteView{W, H, s.top, s.bottom, s.left, s.right, s.bits,
+                    s.rowRuns, s.runX, s.runLen, s.rowMinX, s.rowMaxX};
+}
+
+}  // namespace sprite_compiler
+
+// Declares <name>_data (the compiled tables), <name>_sprite (a SpriteView)
+// and <name> (pointer to the packed bits, for drawScaledBitmap1bpp).
+#define SPRITE_ART(name, W, H, art)                                                  \
+  static_assert(sprite_compiler::rowCount(art) == (H), #name ": art needs " #H " rows");   \
+  static_assert(sprite_compiler::rowsAreWidth(art, W), #name ": art rows must be " #W " wide"); \
+  static_assert(sprite_compiler::onlyArtChars(art), #name ": art may only use '#' and '.'");  \
+  constexpr auto name##_data =                                                       \
+      sprite_compiler::compile<W, H, sprite_compiler::runCount(art)>(art);           \
+  constexpr SpriteView name##_sprite = sprite_compiler::view(name##_data);          \
+  constexpr const uint8_t *name = name##_data.bits
+
+#endif // SPRITE_COMPILER_H
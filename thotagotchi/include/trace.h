@@ -0,0 +1,43 @@
+// Lightweight begin/end trace scopes, dumped over serial on request.
+// Build with -DTHOT_TRACE (see [env:esp32dev-trace]) to enable; otherwise
+// every macro below expands to nothing.
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+
+#ifdef THOT_TRACE
+
+const int TRACE_EVENTS_PER_CORE = 512;   // must be a power of two
+
+struct TraceEvent {
+  int64_t     us;       // esp_timer time: one clock for both cores, no wrap
+  const char *name;     // string literal, never copied
+  char        phase;    // 'B'egin or 'E'nd
+};
+
+void traceBegin();                              // open Serial for dumps
+void traceRecord(const char *name, char phase);
+void traceService();                            // call once each loop()
+
+struct TraceScope {
+  const char *name;
+  explicit TraceScope(const char *n) : name(n) { traceRecord(name, 'B'); }
+  ~TraceScope() { traceRecord(name, 'E'); }
+};
+
+#define TRACE_CAT2(a, b) a##b
+#define TRACE_CAT(a, b)  TRACE_CAT2(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CAT(traceScope_, __LINE__)(name)
+#define TRACE_BEGIN()     traceBegin()
+#define TRACE_SERVICE()   traceService()
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_BEGIN()     ((void)0)
+#define TRACE_SERVICE()   ((void)0)
+
+#endif // THOT_TRACE
+
+#endif // TRACE_H
@@ -0,0 +1,160 @@
+// Screen layout and the draw routines shared by the firmware and the host
+// display model (tools/display_model). Templates on the target, like
+// draw_bitmap.h, so the same code draws to TFT_eSPI / TFT_eSprite on the
+// badge and to St7789Model / SpriteModel on the host.
+// Include after <TFT_eSPI.h> (or display_model.h) for the TFT_* colours.
+#ifndef UI_DRAW_H
+#define UI_DRAW_H
+
+#include <string.h>
+#include "pet_sprites.h"
+#include "pet_anims.h"
+#include "draw_bitmap.h"
+
+// Layout
+const int screenW = 240;
+const int screenH = 240;
+const int spriteW = 240;
+const int spriteH = 179;
+const int spriteY = 20;  // Top of sprite rectangle
+const int buttonY = spriteY + spriteH + 1;
+const int buttonAreaHeight = screenH - buttonY;
+
+const int ballRadius = 12;                // Radius of the beach ball
+const int ballDiameter = ballRadius * 2;  // Convenience
+
+
+// Hearts from hunger and happiness, and a face for the mood
+template <class GFX>
+void drawHudBar(GFX &tft, int hunger, int happiness) {
+  tft.setTextSize(2);
+  tft.setCursor(10, 2);
+
+  int fullHearts = (100 - (hunger / 2) - (50 - happiness / 2)) / 20;
+  for (int i = 0; i < 5; i++) {
+    tft.setTextColor((i < fullHearts) ? TFT_RED : TFT_DARKGREY, TFT_BLACK);
+    tft.print("\x03 ");
+  }
+
+  tft.setCursor(200, 3);
+  tft.setTextColor(TFT_WHITE, TFT_BLACK);
+  if (happiness > 66)
+    tft.print(":)");
+  else if (happiness > 33)
+    tft.print(":|");
+  else
+    tft.print(":(");
+}
+
+
+// Feed / Play / Clean along the bottom, the selected one in yellow
+template <class GFX>
+void drawMenuButtons(GFX &tft, int selected) {
+  const char* labels[] = {"Feed", "Play", "Clean"};
+  int buttonWidth = screenW / 3;
+  tft.setTextSize(2);
+
+  for (int i = 0; i < 3; i++) {
+    int x = i * buttonWidth;
+    uint16_t bg = (i == selected) ? TFT_YELLOW : TFT_WHITE;
+    tft.fillRect(x, buttonY, buttonWidth, buttonAreaHeight, bg);
+    tft.setTextColor(TFT_BLACK, bg);
+    int textX = x + (buttonWidth / 2) - (strlen(labels[i]) * 6);
+    tft.setCursor(textX, buttonY + 10);
+    tft.print(labels[i]);
+  }
+}
+
+
+// Beach ball with its top-left at x, y, slices turned to spin frame
+// `frame`; without slices it is a plain white ball
+template <class GFX>
+void drawBall(GFX &dst, int x, int y, int frame, bool slices = true) {
+  int r = ballRadius;
+  int centerX = x + r;
+  int centerY = y + r;
+
+  // Draw base white circle
+  dst.fillCircle(centerX, centerY, r, TFT_WHITE);
+
+  int numSlices = slices ? 4 : 0;  // red, yellow, blue, green
+  const uint16_t sliceColors[] = {TFT_RED, TFT_YELLOW, TFT_BLUE, TFT_GREEN};
+
+  // each slice sits a quarter turn (3 spin frames) after the previous
+  for (int i = 0; i < numSlices; i++) {
+    int f = (frame + i * 3) % 12;
+    dst.fillCircle(centerX + ballSliceDX[f], centerY + ballSliceDY[f], r / 2, sliceColors[i]);
+  }
+
+  // Center dot
+  dst.fillCircle(centerX, centerY, 3, TFT_WHITE);
+
+  // outer border
+  dst.drawCircle(centerX, centerY, r, TFT_BLACK);
+}
+
+
+// Headstone centred in the target
+template <class GFX>
+void drawGraveStone(GFX &dst) {
+  drawSprite(dst, grave_back_bitmap_sprite, 0, 0, graveScale,
+             TFT_DARKGREY,
+             true, true      // centred X & Y
+  );
+  drawSprite(dst, grave_rip_bitmap_sprite, 0, 0, graveScale,
+             TFT_WHITE,
+             true, true      // centred X & Y
+  );
+}
+
+
+// First splash page: rainbow title, egg and credits
+template <class GFX>
+void drawSplashPage(GFX &tft) {
+  tft.fillScreen(TFT_BLACK);
+  tft.setTextSize(3);
+
+  const char* title = "THoTaGoTcHi";
+  // Rainbow palette (extended ROYGBIV: 11 evenly-spaced hues)
+  const uint16_t titleColors[11] = {
+    TFT_RED,         // Red
+    TFT_ORANGE,      // Red-Orange
+    TFT_YELLOW,      // Yellow
+    TFT_GREENYELLOW, // Yellow-Green
+    TFT_GREEN,       // Green
+    TFT_CYAN,        // Green-Blue
+    TFT_BLUE,        // Blue
+    TFT_NAVY,        // Indigo
+    TFT_PURPLE,      // Violet
+    TFT_MAGENTA,     // Violet-Magenta
+    TFT_PINK         // Pink (tail of spectrum)
+  };
+
+  for (int i = 0; i < (int)strlen(title); i++) {
+    tft.setTextColor(titleColors[i % 11], TFT_BLACK);
+    tft.setCursor(25 + i * 18, 30);
+    tft.print(title[i]);
+  }
+
+  // Draw egg
+  drawSprite(
+    tft,
+    egg_bitmap_sprite,
+    0, 80,           // X, Y on screen
+    eggScale,        // Scale
+    TFT_GOLD,        // foreground (‘1’ bits)
+    true,            // Centered X
+    false            // Centered Y
+  );
+
+  tft.setTextSize(2);
+  tft.setTextColor(TFT_CYAN, TFT_BLACK);
+  tft.setCursor(50, 170);
+  tft.println("Made by Kujo");
+  tft.setCursor(105, 190);
+  tft.println("for");
+  tft.setCursor(55, 210);
+  tft.println("THOTCON 0xD");
+}
+
+#endif // UI_DRAW_H
@@ -0,0 +1,158 @@
+/* Keyframe animation players.
+   Each player remembers which key segment it is in, so advancing is a
+   short forward walk rather than a search, and sampling is one eased
+   lerp per property.
+*/
+
+#include "anim.h"
+#include <TFT_eSPI.h>
+#include "trace.h"
+
+const int ANIM_MAX_PLAYERS = 4;
+
+const uint16_t animPalette[] = {TFT_WHITE, TFT_LIGHTGREY, TFT_DARKGREY, TFT_RED};
+
+// Q8 easing curves sampled at 16 even steps (index 16 = 1.0)
+static const uint16_t easeTable[][17] = {
+  {  0,  16,  32,  48,  64,  80,  96, 112, 128, 144, 160, 176, 192, 208, 224, 240, 256}, // linear
+  {  0,   1,   4,   9,  16,  25,  36,  49,  64,  81, 100, 121, 144, 169, 196, 225, 256}, // in (t^2)
+  {  0,  31,  60,  87, 112, 135, 156, 175, 192, 207, 220, 231, 240, 247, 252, 255, 256}, // out
+  {  0,   2,   8,  18,  32,  50,  72,  98, 128, 158, 184, 206, 224, 238, 248, 254, 256}, // in-out
+};
+
+static AnimPlayer *players[ANIM_MAX_PLAYERS];
+static int playerCount = 0;
+
+
+// u is progress through a segment in Q8 (0..256)
+static int easeQ8(uint8_t ease, int u) {
+  if (ease == EASE_STEP) return 0;
+  const uint16_t *tab = easeTable[ease - EASE_LINEAR];
+  int i = u >> 4, f = u & 15;
+  if (i >= 16) return 256;
+  return tab[i] + (((tab[i + 1] - tab[i]) * f) >> 4);
+}
+
+
+static int lerpQ8(int a, int b, int w) {
+  return a + (((b - a) * w) >> 8);
+}
+
+
+static void sample(AnimPlayer &p) {
+  const AnimClip *c = p.clip;
+  const AnimKey &k0 = c->keys[p.key];
+  bool last = (p.key + 1 >= c->count);
+
+  AnimPose out;
+  out.frame = k0.frame;
+  out.scale = k0.scale;
+  out.palette = k0.palette;
+  out.dx = k0.dx;
+  out.dy = k0.dy;
+
+  if (!last || c->loop) {
+    const AnimKey &k1 = last ? c->keys[0] : c->keys[p.key + 1];
+    uint16_t t1 = last ? c->length : k1.t;
+    uint16_t span = t1 - k0.t;
+    if (span > 0) {
+      int w = easeQ8(k0.ease, ((uint32_t)(p.t - k0.t) << 8) / span);
+      out.dx = lerpQ8(k0.dx, k1.dx, w);
+      out.dy = lerpQ8(k0.dy, k1.dy, w);
+    }
+  }
+
+  // cross-fade offsets; discrete fields flip half way
+  if (p.blendT < p.blendMs) {
+    int w = ((uint32_t)p.blendT << 8) / p.blendMs;
+    out.dx = lerpQ8(p.from.dx, out.dx, w);
+    out.dy = lerpQ8(p.from.dy, out.dy, w);
+    if (w < 128) {
+      out.frame = p.from.frame;
+      out.scale = p.from.scale;
+      out.palette = p.from.palette;
+    }
+  }
+  p.pose = out;
+}
+
+
+static void enterKey(AnimPlayer &p, uint8_t key) {
+  p.key = key;
+  uint8_t cue = p.clip->keys[key].cue;
+  if (cue && p.onCue) p.onCue(cue);
+}
+
+
+static void start(AnimPlayer &p, const AnimClip *clip, uint16_t blendMs) {
+  p.from = p.pose;
+  p.blendMs = p.clip ? blendMs : 0;
+  p.blendT = 0;
+  p.clip = clip;
+  p.t = 0;
+  p.paused = false;
+  enterKey(p, 0);
+  sample(p);
+}
+
+
+void animRegister(AnimPlayer &p, AnimCueFn onCue) {
+  memset(&p, 0, sizeof(p));
+  p.onCue = onCue;
+  if (playerCount < ANIM_MAX_PLAYERS) players[playerCount++] = &p;
+}
+
+
+void animPlay(AnimPlayer &p, const AnimClip *clip, uint16_t blendMs) {
+  p.queued = NULL;
+  if (p.clip == clip) return;
+  start(p, clip, blendMs);
+}
+
+
+void animQueue(AnimPlayer &p, const AnimClip *clip, uint16_t blendMs) {
+  if (!p.clip || p.clip->loop) {
+    animPlay(p, clip, blendMs);
+    return;
+  }
+  p.queued = clip;
+  p.queuedBlendMs = blendMs;
+}
+
+
+static void advance(AnimPlayer &p, uint16_t dtMs) {
+  const AnimClip *c = p.clip;
+  if (p.blendT < p.blendMs) p.blendT = min<uint32_t>(p.blendMs, (uint32_t)p.blendT + dtMs);
+
+  uint32_t t = (uint32_t)p.t + dtMs;
+  if (t >= c->length) {
+    if (!c->loop) {
+      if (p.queued) {
+        const AnimClip *next = p.queued;
+        p.queued = NULL;
+        start(p, next, p.queuedBlendMs);
+        return;
+      }
+      p.t = c->length;        // hold the final key
+      while (p.key + 1 < c->count) enterKey(p, p.key + 1);
+      sample(p);
+      return;
+    }
+    t %= c->length;
+    // finish this lap's keys, then wrap to key 0
+    while (p.key + 1 < c->count) enterKey(p, p.key + 1);
+    enterKey(p, 0);
+  }
+  p.t = t;
+  while (p.key + 1 < c->count && p.t >= c->keys[p.key + 1].t) enterKey(p, p.key + 1);
+  sample(p);
+}
+
+
+void animUpdateAll(uint16_t dtMs) {
+  TRACE_SCOPE("animUpdate");
+  for (int i = 0; i < playerCount; i++) {
+    AnimPlayer &p = *players[i];
+    if (p.clip && !p.paused && dtMs) advance(p, dtMs);
+  }
+}
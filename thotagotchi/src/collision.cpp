@@ -0,0 +1,142 @@
+/* Mask collision.
+   The box reject is inline in collision.h; these run once it passes.
+   Both tests work in a's coordinates. For every row the boxes share, each
+   word of a that the shared columns touch is ANDed with the 32 columns of
+   b that sit under it, pulled out of b's row with two shifts. Bits outside
+   either mask are zero, so no edge masking is needed. masksOverlap() stops
+   at the first non-zero word; masksContact() runs the same scan to the
+   first touching row and only then walks the rest of the overlap for its
+   centroid, so a miss costs the same in both. Every mask row is a single
+   span (see collision.h), so the overlap in a row is one span too, and its
+   first and last bit give its size and middle without counting bits; the
+   ESP32 has no popcount.
+*/
+
+#include "collision.h"
+#include <math.h>
+
+
+const int MAX_LANES = (255 + 31) / 32;   // words in the widest mask row
+
+// The test window: shared rows [y0, y1), and for each word k0..k1 of a
+// that the shared columns touch, where b's 32 columns under it come from.
+// They are set up once per test so the row loop has no bounds checks;
+// a word of b outside its row reads through a zero mask.
+struct Window {
+  int y0, y1, k0, k1;
+  struct Lane {
+    uint8_t hi, lo;          // b's words feeding this lane
+    uint8_t shHi, shLo;
+    uint32_t hiMask, loMask;
+  } lanes[MAX_LANES];
+};
+
+
+// False when the bounding boxes miss (checked again here so the row tests
+// also stand alone)
+static inline bool setupWindow(const CollisionMask &a, int ax, int ay,
+                               const CollisionMask &b, int bx, int by, Window &w) {
+  int x0 = ax > bx ? ax : bx;
+  int x1 = (ax + a.width < bx + b.width) ? ax + a.width : bx + b.width;
+  w.y0 = ay > by ? ay : by;
+  w.y1 = (ay + a.height < by + b.height) ? ay + a.height : by + b.height;
+  if (x0 >= x1 || w.y0 >= w.y1) return false;
+  w.k0 = (x0 - ax) >> 5;
+  w.k1 = (x1 - 1 - ax) >> 5;
+  for (int k = w.k0; k <= w.k1; k++) {
+    Window::Lane &l = w.lanes[k - w.k0];
+    int s = k * 32 - (bx - ax);        // b's column under bit 31 of word k
+    int i = s >> 5;                    // floor(s / 32), also for negative s
+    int sh = s & 31;
+    bool hiOk = i >= 0 && i < b.words;
+    bool loOk = sh && i + 1 >= 0 && i + 1 < b.words;
+    l.hi = hiOk ? i : 0;
+    l.lo = loOk ? i + 1 : 0;
+    l.hiMask = hiOk ? 0xFFFFFFFFu : 0;
+    l.loMask = loOk ? 0xFFFFFFFFu : 0;
+    l.shHi = sh;
+    l.shLo = sh ? 32 - sh : 31;        // never shift by 32; loMask is 0 then
+  }
+  return true;
+}
+
+
+static inline uint32_t laneBits(const Window::Lane &l, const uint32_t *row) {
+  return ((row[l.hi] & l.hiMask) << l.shHi) | ((row[l.lo] & l.loMask) >> l.shLo);
+}
+
+
+bool maskRowsOverlap(const CollisionMask &a, int ax, int ay,
+                     const CollisionMask &b, int bx, int by) {
+  Window w;
+  if (!setupWindow(a, ax, ay, b, bx, by, w)) return false;
+  for (int y = w.y0; y < w.y1; y++) {
+    const uint32_t *ra = a.rows + (y - ay) * a.words;
+    const uint32_t *rb = b.rows + (y - by) * b.words;
+    for (int k = w.k0; k <= w.k1; k++)
+      if (ra[k] & laneBits(w.lanes[k - w.k0], rb)) return true;
+  }
+  return false;
+}
+
+
+bool maskRowsContact(const CollisionMask &a, int ax, int ay,
+                     const CollisionMask &b, int bx, int by, Contact &c) {
+  Window w;
+  if (!setupWindow(a, ax, ay, b, bx, by, w)) return false;
+  // Find the first touching row the cheap way, so a miss costs no more
+  // than in maskRowsOverlap(); the sums start from there
+  int yHit = w.y1;
+  for (int y = w.y0; y < w.y1 && yHit == w.y1; y++) {
+    const uint32_t *ra = a.rows + (y - ay) * a.words;
+    const uint32_t *rb = b.rows + (y - by) * b.words;
+    for (int k = w.k0; k <= w.k1; k++)
+      if (ra[k] & laneBits(w.lanes[k - w.k0], rb)) {
+        yHit = y;
+        break;
+      }
+  }
+  if (yHit == w.y1) return false;
+
+  int32_t n = 0, sumX = 0, sumY = 0;
+  for (int y = yHit; y < w.y1; y++) {
+    const uint32_t *ra = a.rows + (y - ay) * a.words;
+    const uint32_t *rb = b.rows + (y - by) * b.words;
+    int first = -1, last = -1;
+    for (int k = w.k0; k <= w.k1; k++) {
+      uint32_t hit = ra[k] & laneBits(w.lanes[k - w.k0], rb);
+      if (!hit) continue;
+      if (first < 0) first = k * 32 + __builtin_clz(hit);
+      last = k * 32 + 31 - __builtin_ctz(hit);
+    }
+    if (first < 0) continue;
+    // one span per row: its pixels are first..last
+    int cnt = last - first + 1;
+    n += cnt;
+    sumY += cnt * y;
+    sumX += cnt * (2 * ax + first + last) / 2;
+  }
+  if (!n) return false;
+
+  c.pixels = n;
+  c.x = sumX / n;
+  c.y = sumY / n;
+  // Normal: from the contact towards b's centre, which for a round b is
+  // its surface normal. If the contact sits on b's centre, use a -> b.
+  // (+0.5 moves the centroid to pixel centres, like the box centres)
+  float nx = (bx + b.width / 2.0f) - ((float)sumX / n + 0.5f);
+  float ny = (by + b.height / 2.0f) - ((float)sumY / n + 0.5f);
+  if (nx * nx + ny * ny < 0.25f) {
+    nx = (bx + b.width / 2.0f) - (ax + a.width / 2.0f);
+    ny = (by + b.height / 2.0f) - (ay + a.height / 2.0f);
+  }
+  float len = sqrtf(nx * nx + ny * ny);
+  if (len > 0) {
+    c.nx = nx / len;
+    c.ny = ny / len;
+  } else {
+    c.nx = 0;
+    c.ny = -1;
+  }
+  return true;
+}
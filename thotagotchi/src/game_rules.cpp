@@ -0,0 +1,124 @@
+/* Closed-form game rule engine.
+   Every rule is monotone in the number of ticks k: hunger(k) only rises and
+   happiness(k) only falls until they saturate. So each condition is true
+   from (or until) a single tick index, which we solve for directly instead
+   of replaying the ticks.
+*/
+
+#include "game_rules.h"
+
+static const unsigned long NEVER = 0xFFFFFFFFUL;
+
+
+static int valueAfter(int v0, const VitalRule &rule, unsigned long k, bool paused) {
+  if (paused || k == 0) return v0;
+  long v = v0 + (long)rule.perTick * (long)min<unsigned long>(k, 1000UL);
+  return constrain(v, (long)rule.lo, (long)rule.hi);
+}
+
+
+// First tick k >= 0 at which v(k) >= target (v0 counts as tick 0).
+static unsigned long firstTickAtLeast(int v0, const VitalRule &rule, int target, bool paused) {
+  if (v0 >= target) return 0;
+  if (paused || rule.perTick <= 0 || rule.hi < target) return NEVER;
+  return (target - v0 + rule.perTick - 1) / rule.perTick;
+}
+
+
+// First tick k >= 0 at which v(k) <= target.
+static unsigned long firstTickAtMost(int v0, const VitalRule &rule, int target, bool paused) {
+  if (v0 <= target) return 0;
+  if (paused || rule.perTick >= 0 || rule.lo > target) return NEVER;
+  int step = -rule.perTick;
+  return (v0 - target + step - 1) / step;
+}
+
+
+// Time (ms from now) by which k ticks have been applied.
+static unsigned long tickTime(unsigned long k, unsigned long firstTickAt, unsigned long tickMs) {
+  return (k == 0) ? 0 : firstTickAt + (k - 1) * tickMs;
+}
+
+
+// Number of poop checks j in [0, count) that happen at or after time t,
+// where check j happens at first + j * period.
+static unsigned long checksFrom(unsigned long t, unsigned long first,
+                                unsigned long period, unsigned long count) {
+  if (t <= first) return count;
+  unsigned long skipped = (t - first + period - 1) / period;
+  return (skipped >= count) ? 0 : count - skipped;
+}
+
+
+RuleOutcome advanceGame(const GameRules &r, VitalState &v, RuleClock &clock,
+                        unsigned long elapsedMs, bool decayPaused) {
+  RuleOutcome out = {0, 0, false};
+  if (v.dead) return out;
+
+  // ---- game ticks ----
+  unsigned long tickTotal = clock.tickPhaseMs + elapsedMs;
+  unsigned long n = tickTotal / r.tickMs;
+  unsigned long firstTickAt = r.tickMs - clock.tickPhaseMs;   // ms from now
+
+  // Bad ticks start at tick kb and, by monotonicity, never stop
+  unsigned long kh = firstTickAtLeast(v.hunger, r.hunger, r.deathHunger, decayPaused);
+  unsigned long kp = firstTickAtMost(v.happiness, r.happiness, r.deathHappiness, decayPaused);
+  unsigned long kb = max(kh, kp);
+
+  unsigned long deathTick = NEVER;   // tick index (1-based) that kills
+  if (kb <= 1) deathTick = (unsigned long)max(1, r.deathThreshold - v.badTicks);
+  else if (kb != NEVER) deathTick = kb + r.deathThreshold - 1;
+
+  unsigned long ticksRun = n;
+  if (deathTick <= n) {
+    ticksRun = deathTick;
+    out.died = true;
+  }
+
+  // ---- poop checks, up to and including the moment of death ----
+  unsigned long poopTotal = clock.poopPhaseMs + elapsedMs;
+  unsigned long m = poopTotal / r.poopCheckMs;
+  unsigned long firstCheckAt = r.poopCheckMs - clock.poopPhaseMs;
+  if (out.died) {
+    unsigned long deathAt = firstTickAt + (deathTick - 1) * r.tickMs;
+    m = (deathAt < firstCheckAt) ? 0 : min(m, (deathAt - firstCheckAt) / r.poopCheckMs + 1);
+  }
+
+  if (m > 0) {
+    // A check sees the state after every tick at or before it. It spawns
+    // while hunger is still low (ticks < kLow) and again once hunger is
+    // high or happiness low (ticks >= kHigh).
+    unsigned long kLow = firstTickAtLeast(v.hunger, r.hunger, r.poopHungerBelow, decayPaused);
+    unsigned long kHigh = min(
+        firstTickAtLeast(v.hunger, r.hunger, r.poopHungerAbove + 1, decayPaused),
+        firstTickAtMost(v.happiness, r.happiness, r.poopHappinessBelow - 1, decayPaused));
+
+    if (kHigh <= kLow) {
+      out.poops = m;
+    } else {
+      unsigned long low = (kLow == NEVER) ? m : m - checksFrom(tickTime(kLow, firstTickAt, r.tickMs), firstCheckAt, r.poopCheckMs, m);
+      unsigned long high = (kHigh == NEVER) ? 0 : checksFrom(tickTime(kHigh, firstTickAt, r.tickMs), firstCheckAt, r.poopCheckMs, m);
+      out.poops = low + high;
+    }
+  }
+
+  // ---- apply ----
+  if (ticksRun > 0) {
+    int h = valueAfter(v.hunger, r.hunger, ticksRun, decayPaused);
+    int p = valueAfter(v.happiness, r.happiness, ticksRun, decayPaused);
+    if (kb <= 1) v.badTicks += ticksRun;
+    else if (kb <= ticksRun) v.badTicks = ticksRun - kb + 1;
+    else v.badTicks = 0;
+    v.hunger = h;
+    v.happiness = p;
+  }
+  out.ticks = ticksRun;
+
+  if (out.died) {
+    v.badTicks = r.deathThreshold;
+    v.dead = true;
+  }
+  clock.tickPhaseMs = tickTotal % r.tickMs;
+  clock.poopPhaseMs = poopTotal % r.poopCheckMs;
+  return out;
+}
@@ -0,0 +1,89 @@
+/* Frame-budget governor.
+   Stepping down is quick: a few missed frames in a row, or the smoothed
+   cost over budget. Stepping up is slow: the smoothed cost has to stay
+   well under budget for about a second. After any change the level is
+   held for a while, so one knob gets time to show its effect before the
+   next one moves and a level near the edge doesn't flap.
+   Misses are judged against the current level's frame period, headroom
+   against the period of the level above, so dropping to half rate does
+   not by itself look like room to step back up.
+*/
+
+#include "governor.h"
+
+const int MISS_STREAK_DOWN = 3;           // consecutive misses that force a step down
+const int HEADROOM_PERCENT = 70;          // of the next level up's budget
+const int HEADROOM_FRAMES_UP = 30;        // frames of headroom before stepping up
+const int HOLD_FRAMES = 15;               // frames after a change with no further change
+
+GovernorStats governorStats;
+
+static int missStreak = 0;
+static int headroomFrames = 0;
+static int holdFrames = 0;
+static bool skipNext = false;
+
+
+uint32_t governorBudgetUs(int level) {
+  return level >= QUALITY_HALF_RATE ? FRAME_BUDGET_US * 2 : FRAME_BUDGET_US;
+}
+
+
+void governorSkipFrame() {
+  skipNext = true;
+}
+
+
+static void setLevel(int level) {
+  if (level > governorStats.level) governorStats.stepDowns++;
+  else governorStats.stepUps++;
+  governorStats.level = level;
+  if (level > governorStats.peakLevel) governorStats.peakLevel = level;
+  missStreak = 0;
+  headroomFrames = 0;
+  holdFrames = HOLD_FRAMES;
+}
+
+
+bool governorFrame(uint32_t simUs, uint32_t drawUs) {
+  GovernorStats &g = governorStats;
+  uint32_t frameUs = simUs + drawUs;
+  g.frames++;
+  if (skipNext) {
+    skipNext = false;
+    g.skipped++;
+    return false;
+  }
+  g.lastSimUs = simUs;
+  g.lastDrawUs = drawUs;
+  g.lastFrameUs = frameUs;
+  // EMA with 1/8 weight; seeded by the first counted frame
+  if (g.frames - g.skipped == 1) g.avgFrameUs = frameUs;
+  else g.avgFrameUs = g.avgFrameUs - g.avgFrameUs / 8 + frameUs / 8;
+
+  uint32_t budget = governorBudgetUs(g.level);
+  uint32_t headroom = governorBudgetUs(g.level > QUALITY_FULL ? g.level - 1 : g.level) *
+                      HEADROOM_PERCENT / 100;
+  if (frameUs > budget) {
+    g.misses++;
+    missStreak++;
+  } else {
+    missStreak = 0;
+  }
+  headroomFrames = (g.avgFrameUs < headroom) ? headroomFrames + 1 : 0;
+
+  if (holdFrames > 0) {
+    holdFrames--;
+    return false;
+  }
+  if ((missStreak >= MISS_STREAK_DOWN || g.avgFrameUs > budget) &&
+      g.level < QUALITY_LEVELS - 1) {
+    setLevel(g.level + 1);
+    return true;
+  }
+  if (headroomFrames >= HEADROOM_FRAMES_UP && g.level > QUALITY_FULL) {
+    setLevel(g.level - 1);
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,408 @@
+/* Vitals history ring.
+   Tokens, MSB first, all relative to the previous sample:
+     0                    one more sample with the previous delta
+     10 nnnnnnnnnnnnnn    n + 2 more samples with the previous delta
+     110 hhhhh ppppp      new delta, each a signed 5-bit value
+     1110 hhhhhhh ppppppp new absolute values (delta too big for 5 bits)
+   The "previous delta" is (0, 0) at the start of every block. Samples are
+   not written straight away: a run of equal deltas is counted and only
+   emitted as tokens when the delta changes, so a flat week costs nothing
+   until something happens.
+*/
+
+#include "history.h"
+#include "trace.h"
+#include <Preferences.h>
+
+const uint32_t HISTORY_MAGIC = 0x4B157001;
+const int HISTORY_PAYLOAD_BITS = (HISTORY_BLOCK_BYTES - 8) * 8;
+const int RUN_BITS = 14;
+const uint32_t RUN_MAX = (1UL << RUN_BITS) + 1;
+const unsigned long NEVER = 0xFFFFFFFFUL;
+
+struct HistoryBlock {
+  uint32_t firstSample;      // index of the first sample in this block
+  uint8_t  hunger;           // vitals just before it (keyframe)
+  uint8_t  happiness;
+  uint16_t bits;             // payload bits written
+  uint8_t  data[HISTORY_BLOCK_BYTES - 8];
+};
+
+struct HistoryStore {
+  uint32_t magic;
+  uint16_t head;             // block being written
+  uint16_t used;             // blocks holding data, <= HISTORY_BLOCKS
+  uint32_t samples;          // samples emitted as tokens so far
+  uint32_t savedAt;          // samples + runCount at the last flash save
+  uint8_t  lastH, lastP;     // value after the last emitted sample
+  int8_t   prevDH, prevDP;   // delta of the last emitted sample, this block
+  int8_t   runDH, runDP;     // pending run not yet emitted
+  uint32_t runCount;
+  HistoryBlock blocks[HISTORY_BLOCKS];
+};
+
+HistoryStats historyStats;
+
+static RTC_DATA_ATTR HistoryStore store;
+
+
+// ---- writing ----
+
+static HistoryBlock &headBlock() {
+  return store.blocks[store.head];
+}
+
+
+static void startBlock() {
+  if (store.used > 0) store.head = (store.head + 1) % HISTORY_BLOCKS;
+  if (store.used < HISTORY_BLOCKS) store.used++;
+  HistoryBlock &b = headBlock();
+  b.firstSample = store.samples;
+  b.hunger = store.lastH;
+  b.happiness = store.lastP;
+  b.bits = 0;
+  store.prevDH = store.prevDP = 0;
+}
+
+
+static bool room(int n) {
+  return headBlock().bits + n <= HISTORY_PAYLOAD_BITS;
+}
+
+
+static void putBits(uint32_t v, int n) {
+  HistoryBlock &b = headBlock();
+  for (int i = n - 1; i >= 0; i--) {
+    int pos = b.bits++;
+    uint8_t mask = 0x80 >> (pos & 7);
+    if ((v >> i) & 1) b.data[pos >> 3] |= mask;
+    else b.data[pos >> 3] &= ~mask;
+  }
+}
+
+
+static bool fitsSmall(int d) {
+  return d >= -16 && d <= 15;
+}
+
+
+static void emitted(uint32_t n) {
+  store.lastH += store.runDH * (int)n;
+  store.lastP += store.runDP * (int)n;
+  store.samples += n;
+  store.runCount -= n;
+}
+
+
+// Turn the pending run into tokens, opening new blocks as they fill
+static void flushRun() {
+  while (store.runCount > 0) {
+    if (store.runDH != store.prevDH || store.runDP != store.prevDP) {
+      bool small = fitsSmall(store.runDH) && fitsSmall(store.runDP);
+      if (!room(small ? 13 : 18)) { startBlock(); continue; }
+      if (small) {
+        putBits(0x6, 3);
+        putBits(store.runDH & 0x1F, 5);
+        putBits(store.runDP & 0x1F, 5);
+      } else {
+        putBits(0xE, 4);
+        putBits(store.lastH + store.runDH, 7);
+        putBits(store.lastP + store.runDP, 7);
+      }
+      store.prevDH = store.runDH;
+      store.prevDP = store.runDP;
+      emitted(1);
+    } else if (store.runCount == 1) {
+      if (!room(1)) { startBlock(); continue; }
+      putBits(0, 1);
+      emitted(1);
+    } else {
+      if (!room(2 + RUN_BITS)) { startBlock(); continue; }
+      uint32_t n = min(store.runCount, RUN_MAX);
+      putBits(0x2, 2);
+      putBits(n - 2, RUN_BITS);
+      emitted(n);
+    }
+  }
+}
+
+
+static void resetStore(int hunger, int happiness) {
+  memset(&store, 0, sizeof(store));
+  store.magic = HISTORY_MAGIC;
+  store.lastH = constrain(hunger, 0, 127);
+  store.lastP = constrain(happiness, 0, 127);
+  startBlock();
+}
+
+
+void historyInit(int hunger, int happiness) {
+  if (store.magic == HISTORY_MAGIC) return;     // kept through deep sleep
+
+  Preferences prefs;
+  if (prefs.begin("history", true)) {
+    bool ok = prefs.getBytesLength("ring") == sizeof(store) &&
+              prefs.getBytes("ring", &store, sizeof(store)) == sizeof(store) &&
+              store.magic == HISTORY_MAGIC;
+    prefs.end();
+    if (ok) return;
+  }
+  resetStore(hunger, happiness);
+}
+
+
+void historyRecord(int hunger, int happiness) {
+  hunger = constrain(hunger, 0, 127);
+  happiness = constrain(happiness, 0, 127);
+  int curH = store.lastH + store.runDH * (int)store.runCount;
+  int curP = store.lastP + store.runDP * (int)store.runCount;
+  int dh = hunger - curH, dp = happiness - curP;
+
+  if (store.runCount > 0 && dh == store.runDH && dp == store.runDP) {
+    store.runCount++;
+    return;
+  }
+  flushRun();
+  store.runDH = dh;
+  store.runDP = dp;
+  store.runCount = 1;
+}
+
+
+// Add n more samples carrying on the pending run's delta
+static void extendRun(unsigned long n) {
+  store.runCount += n;
+}
+
+
+// Last tick t at which v0 + t * perTick is still inside the limits
+static unsigned long lastFullStep(int v0, const VitalRule &rule, bool paused) {
+  if (paused || rule.perTick == 0) return NEVER;
+  long span = (rule.perTick > 0) ? rule.hi - v0 : v0 - rule.lo;
+  if (span <= 0) return 0;
+  return span / abs(rule.perTick);
+}
+
+
+static int valueAt(int v0, const VitalRule &rule, unsigned long t, bool paused) {
+  if (paused) return v0;
+  long v = v0 + (long)rule.perTick * (long)min<unsigned long>(t, 1000UL);
+  return constrain(v, (long)rule.lo, (long)rule.hi);
+}
+
+
+void historyRecordTicks(const GameRules &r, int hunger, int happiness,
+                        unsigned long ticks, bool decayPaused) {
+  TRACE_SCOPE("historyRecord");
+  // Each vital moves by perTick until one partial step into its limit
+  // and then holds, so the per-tick deltas only change at ticks kf + 1
+  // and kf + 2. Between those breakpoints the deltas are constant.
+  unsigned long cuts[4];
+  int nCuts = 0;
+  unsigned long kh = lastFullStep(hunger, r.hunger, decayPaused);
+  unsigned long kp = lastFullStep(happiness, r.happiness, decayPaused);
+  if (kh != NEVER) { cuts[nCuts++] = kh + 1; cuts[nCuts++] = kh + 2; }
+  if (kp != NEVER) { cuts[nCuts++] = kp + 1; cuts[nCuts++] = kp + 2; }
+
+  unsigned long a = 1;
+  while (a <= ticks) {
+    unsigned long b = ticks + 1;
+    for (int i = 0; i < nCuts; i++)
+      if (cuts[i] > a && cuts[i] < b) b = cuts[i];
+
+    historyRecord(valueAt(hunger, r.hunger, a, decayPaused),
+                  valueAt(happiness, r.happiness, a, decayPaused));
+    if (b - a >= 2) {
+      historyRecord(valueAt(hunger, r.hunger, a + 1, decayPaused),
+                    valueAt(happiness, r.happiness, a + 1, decayPaused));
+      extendRun(b - a - 2);
+    }
+    a = b;
+  }
+}
+
+
+void historySave(bool force) {
+  uint32_t total = store.samples + store.runCount;
+  if (!force && total - store.savedAt < HISTORY_SAVE_EVERY) return;
+  TRACE_SCOPE("historySave");
+  store.savedAt = total;
+  Preferences prefs;
+  if (prefs.begin("history", false)) {
+    prefs.putBytes("ring", &store, sizeof(store));
+    prefs.end();
+  }
+}
+
+
+// ---- reading ----
+
+// Calls fn(h, p, dh, dp, n, ctx) for every run of n samples, oldest
+// first: sample j (1..n) of the run is (h + j * dh, p + j * dp).
+typedef void (*HistorySpanFn)(int h, int p, int dh, int dp, uint32_t n, void *ctx);
+
+static uint32_t getBits(const HistoryBlock &b, int &pos, int n) {
+  uint32_t v = 0;
+  while (n--) {
+    v = (v << 1) | ((b.data[pos >> 3] >> (7 - (pos & 7))) & 1);
+    pos++;
+  }
+  return v;
+}
+
+
+static int signExtend5(uint32_t v) {
+  return (v & 0x10) ? (int)v - 32 : (int)v;
+}
+
+
+static void walkHistory(HistorySpanFn fn, void *ctx) {
+  for (int k = 0; k < store.used; k++) {
+    const HistoryBlock &b = store.blocks[(store.head + HISTORY_BLOCKS - store.used + 1 + k) % HISTORY_BLOCKS];
+    int h = b.hunger, p = b.happiness, dh = 0, dp = 0;
+    int pos = 0;
+    while (pos < b.bits) {
+      uint32_t n = 1;
+      if (getBits(b, pos, 1) == 0) {
+        // repeat once
+      } else if (getBits(b, pos, 1) == 0) {
+        n = getBits(b, pos, RUN_BITS) + 2;
+      } else if (getBits(b, pos, 1) == 0) {
+        dh = signExtend5(getBits(b, pos, 5));
+        dp = signExtend5(getBits(b, pos, 5));
+      } else {
+        getBits(b, pos, 1);
+        int nh = getBits(b, pos, 7), np = getBits(b, pos, 7);
+        dh = nh - h;
+        dp = np - p;
+      }
+      fn(h, p, dh, dp, n, ctx);
+      h += dh * (int)n;
+      p += dp * (int)n;
+    }
+  }
+  if (store.runCount > 0)
+    fn(store.lastH, store.lastP, store.runDH, store.runDP, store.runCount, ctx);
+}
+
+
+static const HistoryBlock &oldestBlock() {
+  return store.blocks[(store.head + HISTORY_BLOCKS - store.used + 1) % HISTORY_BLOCKS];
+}
+
+
+// Min/max of both vitals per screen column, filled span by span
+struct GraphState {
+  TFT_eSprite *dst;
+  int w, top, plotH;
+  uint32_t total;       // samples across the graph
+  uint32_t i;           // samples consumed
+  int col;              // column being accumulated
+  int hMin, hMax, pMin, pMax;
+  int lastH, lastP;
+};
+
+
+static int vitalY(const GraphState &g, int v) {
+  return g.top + (100 - constrain(v, 0, 100)) * (g.plotH - 1) / 100;
+}
+
+
+// Draw the accumulated range into column g.col, then hold the last value
+// flat up to toCol (one sample can span several columns)
+static void flushColumns(GraphState &g, int toCol) {
+  for (int c = g.col; c < toCol && c < g.w; c++) {
+    int y0 = vitalY(g, g.hMax), y1 = vitalY(g, g.hMin);
+    g.dst->drawFastVLine(c, y0, y1 - y0 + 1, TFT_ORANGE);
+    y0 = vitalY(g, g.pMax); y1 = vitalY(g, g.pMin);
+    g.dst->drawFastVLine(c, y0, y1 - y0 + 1, TFT_CYAN);
+    // each column starts at the previous last value so the trace stays joined
+    g.hMin = g.hMax = g.lastH;
+    g.pMin = g.pMax = g.lastP;
+  }
+  g.col = toCol;
+}
+
+
+static void graphSpan(int h, int p, int dh, int dp, uint32_t n, void *ctx) {
+  GraphState &g = *(GraphState *)ctx;
+  uint32_t j = 0;
+  while (j < n) {
+    // samples left before the next column starts
+    uint32_t colEnd = (uint32_t)(((uint64_t)(g.col + 1) * g.total + g.w - 1) / g.w);
+    uint32_t k = (colEnd > g.i) ? min(n - j, colEnd - g.i) : 1;
+
+    // values move linearly inside a span: the ends are the extremes
+    int ha = h + dh * (int)(j + 1), hb = h + dh * (int)(j + k);
+    int pa = p + dp * (int)(j + 1), pb = p + dp * (int)(j + k);
+    g.hMin = min(g.hMin, min(ha, hb)); g.hMax = max(g.hMax, max(ha, hb));
+    g.pMin = min(g.pMin, min(pa, pb)); g.pMax = max(g.pMax, max(pa, pb));
+    g.lastH = hb;
+    g.lastP = pb;
+    j += k;
+    g.i += k;
+
+    int nextCol = (int)((uint64_t)g.i * g.w / g.total);
+    if (nextCol > g.col) flushColumns(g, nextCol);
+  }
+}
+
+
+void historyDrawGraph(TFT_eSprite &dst, int w, int h) {
+  TRACE_SCOPE("historyGraph");
+  unsigned long start = micros();
+  const HistoryStats &s = historyGetStats();
+
+  dst.fillSprite(TFT_BLACK);
+  dst.setTextSize(1);
+  dst.setTextColor(TFT_ORANGE, TFT_BLACK);
+  dst.setCursor(2, 2);
+  dst.print("hunger");
+  dst.setTextColor(TFT_CYAN, TFT_BLACK);
+  dst.setCursor(50, 2);
+  dst.print("happy");
+
+  // span covered, in game time
+  char line[48];
+  unsigned long mins = (unsigned long)s.samples * 5 / 60;
+  snprintf(line, sizeof(line), "%lud %luh %lum", mins / 1440, mins / 60 % 24, mins % 60);
+  dst.setTextColor(TFT_WHITE, TFT_BLACK);
+  dst.setCursor(150, 2);
+  dst.print(line);
+
+  const int top = 14, bottom = h - 12;
+  dst.drawFastHLine(0, top - 1, w, TFT_DARKGREY);
+  dst.drawFastHLine(0, bottom, w, TFT_DARKGREY);
+
+  if (s.samples > 0) {
+    GraphState g;
+    g.dst = &dst;
+    g.w = w;
+    g.top = top;
+    g.plotH = bottom - top;
+    g.total = s.samples;
+    g.i = 0;
+    g.col = 0;
+    const HistoryBlock &first = oldestBlock();
+    g.lastH = g.hMin = g.hMax = first.hunger;
+    g.lastP = g.pMin = g.pMax = first.happiness;
+    walkHistory(graphSpan, &g);
+  }
+
+  historyStats.renderUs = micros() - start;
+  snprintf(line, sizeof(line), "%luB %lu smp %luus",
+           (unsigned long)s.bytesUsed, (unsigned long)s.samples,
+           (unsigned long)historyStats.renderUs);
+  dst.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+  dst.setCursor(2, h - 9);
+  dst.print(line);
+}
+
+
+const HistoryStats &historyGetStats() {
+  historyStats.samples = store.used ? store.samples + store.runCount - oldestBlock().firstSample : 0;
+  historyStats.footprint = sizeof(store);
+  historyStats.bytesUsed = store.used ? (store.used - 1) * HISTORY_BLOCK_BYTES +
+                                        8 + (headBlock().bits + 7) / 8 : 0;
+  return historyStats;
+}
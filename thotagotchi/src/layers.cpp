@@ -0,0 +1,79 @@
+/* Background cache and dirty-rectangle restore.
+   Up to LAYER_MAX_RECTS rectangles are tracked per frame; past that,
+   new ones are folded into the last slot so marking never fails.
+*/
+
+#include "layers.h"
+#include "trace.h"
+
+const int LAYER_MAX_RECTS = 12;
+
+struct Rect {
+  int16_t x0, y0, x1, y1;   // x1/y1 exclusive
+};
+
+LayerStats layerStats;
+
+static uint8_t *bgBuf = NULL, *fgBuf = NULL;
+static int bufW = 0, bufH = 0;
+static Rect dirty[LAYER_MAX_RECTS];
+static int dirtyCount = 0;
+
+
+void layersInit(uint8_t *bg, uint8_t *fg, int w, int h) {
+  bgBuf = bg;
+  fgBuf = fg;
+  bufW = w;
+  bufH = h;
+  dirtyCount = 0;
+}
+
+
+void layersMarkDirty(int x, int y, int w, int h) {
+  Rect r;
+  r.x0 = max(x, 0);
+  r.y0 = max(y, 0);
+  r.x1 = min(x + w, bufW);
+  r.y1 = min(y + h, bufH);
+  if (r.x0 >= r.x1 || r.y0 >= r.y1) return;
+
+  if (dirtyCount < LAYER_MAX_RECTS) {
+    dirty[dirtyCount++] = r;
+    return;
+  }
+  Rect &u = dirty[LAYER_MAX_RECTS - 1];
+  u.x0 = min(u.x0, r.x0);
+  u.y0 = min(u.y0, r.y0);
+  u.x1 = max(u.x1, r.x1);
+  u.y1 = max(u.y1, r.y1);
+}
+
+
+void layersRestore() {
+  TRACE_SCOPE("layersRestore");
+  unsigned long start = micros();
+  uint32_t px = 0;
+
+  for (int i = 0; i < dirtyCount; i++) {
+    const Rect &r = dirty[i];
+    int len = r.x1 - r.x0;
+    for (int y = r.y0; y < r.y1; y++) {
+      size_t off = (size_t)y * bufW + r.x0;
+      memcpy(fgBuf + off, bgBuf + off, len);
+    }
+    px += (uint32_t)len * (r.y1 - r.y0);
+  }
+
+  layerStats.rects = dirtyCount;
+  layerStats.restoredPx = px;
+  layerStats.restoreUs = micros() - start;
+  dirtyCount = 0;
+}
+
+
+void layersRestoreAll() {
+  TRACE_SCOPE("layersRestoreAll");
+  memcpy(fgBuf, bgBuf, (size_t)bufW * bufH);
+  dirtyCount = 0;
+  layerStats.rebuilds++;
+}
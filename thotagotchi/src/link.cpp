@@ -0,0 +1,99 @@
+/* Framed serial link for the Thotagotchi badge.
+   RX collects one candidate frame at a time from the UART driver's buffer.
+   A bad length or CRC drops only the sync byte and rescans what follows,
+   so a corrupted frame never swallows the good one behind it.
+   TX goes through the Arduino UART driver's ring buffer, which its ISR
+   drains in the background, so linkSend() only ever copies bytes.
+*/
+
+#include "link.h"
+#include "trace.h"
+
+#ifdef THOT_SERIAL_LINK
+
+LinkStats linkStats;
+
+static LinkHandler linkHandler = NULL;
+static uint8_t rxBuf[LINK_MAX_PAYLOAD + 5];   // candidate frame, sync first
+static int rxHave = 0;
+
+
+uint16_t linkCrc16(const uint8_t *data, size_t len, uint16_t crc) {
+  while (len--) {
+    crc ^= (uint16_t)*data++ << 8;
+    for (int i = 0; i < 8; i++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+
+void linkBegin(LinkHandler handler) {
+  linkHandler = handler;
+  Serial.setRxBufferSize(1024);
+  Serial.setTxBufferSize(LINK_TX_BUFFER);
+  Serial.begin(LINK_BAUD);
+}
+
+
+static void rxDrop(int n) {
+  memmove(rxBuf, rxBuf + n, rxHave - n);
+  rxHave -= n;
+}
+
+
+static void rxByte(uint8_t b) {
+  rxBuf[rxHave++] = b;
+  while (rxHave > 0) {
+    if (rxBuf[0] != LINK_SYNC) { rxDrop(1); continue; }
+    if (rxHave < 2) return;
+    int len = rxBuf[1];
+    if (len > LINK_MAX_PAYLOAD) {
+      linkStats.rxBad++;
+      rxDrop(1);
+      continue;
+    }
+    if (rxHave < len + 5) return;
+
+    uint16_t crc = rxBuf[len + 3] | (uint16_t)rxBuf[len + 4] << 8;
+    if (linkCrc16(rxBuf + 1, len + 2) != crc) {
+      // not a frame after all; look for a sync byte inside it
+      linkStats.rxBad++;
+      rxDrop(1);
+      continue;
+    }
+    linkStats.rxFrames++;
+    if (linkHandler) linkHandler(rxBuf[2], rxBuf + 3, len);
+    rxDrop(len + 5);
+  }
+}
+
+
+void linkService() {
+  TRACE_SCOPE("linkService");
+  int n = Serial.available();
+  while (n-- > 0) rxByte(Serial.read());
+}
+
+
+bool linkSend(uint8_t type, const void *payload, uint8_t len) {
+  uint8_t frame[LINK_MAX_PAYLOAD + 5];
+  if (len > LINK_MAX_PAYLOAD) len = LINK_MAX_PAYLOAD;
+  int size = len + 5;
+  if (Serial.availableForWrite() < size) {
+    linkStats.txDropped++;
+    return false;
+  }
+  frame[0] = LINK_SYNC;
+  frame[1] = len;
+  frame[2] = type;
+  if (len) memcpy(frame + 3, payload, len);
+  uint16_t crc = linkCrc16(frame + 1, len + 2);
+  frame[3 + len] = crc & 0xFF;
+  frame[4 + len] = crc >> 8;
+  Serial.write(frame, size);
+  linkStats.txFrames++;
+  return true;
+}
+
+#endif // THOT_SERIAL_LINK
@@ -5,9 +5,25 @@
 #include <Arduino.h>
 #include <TFT_eSPI.h>
 #include "pet_sprites.h"
+#include "draw_bitmap.h"
+#include "ui_draw.h"
+#include "trace.h"
+#include "pet_ai.h"
+#include "game_rules.h"
+#include "sleep_mode.h"
+#include "pet_anims.h"
+#include "particles.h"
+#include "layers.h"
+#include "history.h"
+#include "link.h"
+#include "governor.h"
+#include "pet_masks.h"
 
 TFT_eSPI tft = TFT_eSPI();
 TFT_eSprite petLayer = TFT_eSprite(&tft);
+TFT_eSprite bgLayer = TFT_eSprite(&tft);     // cached static art under petLayer
+bool bgDirty = true;                          // bgLayer needs re-rendering
+bool graveUp = false;                         // grave scene is baked into bgLayer
 
 // Pin definitions
 #define BUZZER_PIN 5
@@ -19,15 +35,8 @@ const int ledPins[] = {21, 22, 19, 17, 16, 25};
 
 // Constants
 const int NUM_LEDS = 6;
-const int screenW = 240;
-const int screenH = 240;
-
-const int spriteW = 240;
-const int spriteH = 179;
-const int spriteY = 20;  // Top of sprite rectangle
-const int buttonY = spriteY + spriteH + 1;
+// screen layout: see ui_draw.h
 const int centerThreshold = 40;
-const int buttonAreaHeight = screenH - buttonY;
 
 const int petWidth = petBitmapWidth * petScale;
 const int petHeight = petBitmapHeight * petScale;
@@ -48,10 +57,11 @@ bool menuChanged = true;
 // Movement
 enum MoveMode { WANDER, DVD_BOUNCE };
 MoveMode moveMode = WANDER;
-unsigned long lastUpdate = 0;
-unsigned long gameTickInterval = 5000;
+unsigned long lastUpdate = 0;                 // last time the rules ran
+const unsigned long gameTickInterval = 5000;
 unsigned long lastFrameTime = 0;
 const unsigned long frameInterval = 100;
+unsigned long lastRenderTime = 0;
 
 int petX = 60;
 int petY = 60;
@@ -68,6 +78,8 @@ int wanderDY = 1;
 unsigned long lastMoveStep = 0;
 const unsigned long wanderInterval = 500; // ms per move
 
+const unsigned long aiPlanBudgetUs = 400;  // A* time slice per loop()
+
 unsigned long lastIdleChirp = 0;
 const unsigned long idleChirpCheckInterval = 3000; // Check every x seconds
 
@@ -79,8 +91,17 @@ struct Poop {
 };
 const int MAX_POOPS = 25;
 Poop poops[MAX_POOPS];
-unsigned long lastPoopCheck = 0;
-unsigned long poopCheckInterval = 5000;
+const unsigned long poopCheckInterval = 5000;
+
+// Vitals, poop and death rules, advanced by elapsed time (see game_rules.h)
+const GameRules gameRules = {
+  { hungerDecay, 0, maxHunger },          // hunger rises each tick
+  { -happinessDecay, 0, maxHappiness },   // happiness falls each tick
+  maxHunger, 0, deathThreshold,           // starving and miserable kills
+  80, 20, 15,                             // poop if hunger > 80, happiness < 20 or hunger < 15
+  gameTickInterval, poopCheckInterval
+};
+RuleClock ruleClock = {0, 0};
 
 // Eating mode
 bool isEating = false;
@@ -88,25 +109,31 @@ unsigned long eatingStartTime = 0;
 bool foodActive = false;
 bool hasEatenCurrentFood = false;
 int foodX, foodY = 0;
-int bounceCount = 0;
-unsigned long lastBounceTime = 0;
-const int bounceInterval = 300;  // ms between up/down jumps after eating
-bool bounceUp = true;
 
 // Play mode
 bool isPlaying = false;
 unsigned long playingStartTime = 0;
 const unsigned long playTimeout = 6000;   // seconds of play time
-const int ballRadius = 12;                // Radius of the beach ball
-const int ballDiameter = ballRadius * 2;  // Convenience
 int ballX, ballY;                         // Ball position
 float ballVX, ballVY = 0;
-float ballColorOffset = 0;                // degrees, for beach ball spin
 const float ballFriction = 0.98;          // Slow down gradually
 const float ballSpeed = 3;                // How hard the pet hits the ball
 unsigned long lastBallHit = 0;
 const unsigned long ballHitCooldown = 300;  // ms cooldown between hits
 
+// Animation
+AnimPlayer petAnim;                       // offsets, face and colour of the pet
+AnimPlayer ballAnim;                      // beach ball spin frame
+unsigned long lastAnimTime = 0;
+const SpriteView *const petFrames[] = {&pet_happy_sprite, &pet_sad_sprite, &pet_dead_sprite};
+
+// Collision masks: pet_masks.h
+
+// Particles
+unsigned long lastParticleTime = 0;
+unsigned long lastStinkTime = 0;
+const unsigned long stinkInterval = 400;  // ms between stink puffs per poop
+
 // Touch
 bool touchDetected = false;
 int currentMenuIndex = 0;
@@ -117,6 +144,26 @@ const int TOUCH_ON_DELTA = 15;
 const int TOUCH_OFF_DELTA = 5;
 int baseline0, baseline1, baseline2, baselineSelect;
 
+// Deep sleep
+unsigned long lastTouchTime = 0;
+const unsigned long sleepAfterIdle = 120000;   // ms without touch before sleeping
+const unsigned long deathScreenTime = 5000;    // ms the grave stays up before sleeping
+bool wokeDead = false;                         // pet was already dead when we woke
+
+// Vitals history screen
+unsigned long upHoldStart = 0;                 // when Center went down with Up selected
+const unsigned long historyHoldTime = 1500;    // hold Up + Center this long for the graph
+const unsigned long historyScreenTime = 15000; // graph closes by itself after this
+
+#ifdef THOT_SERIAL_LINK
+// Serial link: injected input and telemetry
+int linkWheelAngle = -1;                       // injected wheel touch in degrees, -1 none
+bool linkCenter = false;                       // injected center press
+uint8_t linkStreamMask = 0;                    // LINK_STREAM_* the host asked for
+unsigned long linkStatePeriod = 0;             // ms between state snapshots, 0 = off
+unsigned long lastLinkState = 0;
+#endif
+
 void calibrateTouch() {
   long sum0 = 0, sum1 = 0, sum2 = 0, sumSelect = 0;
   for (int i = 0; i < 100; i++) {
@@ -134,6 +181,14 @@ void calibrateTouch() {
 
 
 bool readTouchWheelAngle(float &angle_out) {
+  TRACE_SCOPE("touchSample");
+#ifdef THOT_SERIAL_LINK
+  if (linkWheelAngle >= 0) {
+    angle_out = linkWheelAngle;
+    touchDetected = true;
+    return true;
+  }
+#endif
   int v0 = touchRead(Q2_TOUCH_PIN);
   int v1 = touchRead(Q1_TOUCH_PIN);
   int v2 = touchRead(Q3_TOUCH_PIN);
@@ -183,11 +238,17 @@ bool readTouchWheelAngle(float &angle_out) {
 
 
 bool isCenterPressed() {
+  TRACE_SCOPE("centerSample");
+#ifdef THOT_SERIAL_LINK
+  if (linkCenter) return true;
+#endif
   return (touchRead(SELECT_TOUCH_PIN) < (baselineSelect - centerThreshold));
 }
 
 
 void playTone(int freq, int duration) {
+  TRACE_SCOPE("playTone");
+  governorSkipFrame();   // blocks; don't charge it to the frame
   tone(BUZZER_PIN, freq, duration);
   delay(duration); // blocking, but fine for short effects
   noTone(BUZZER_PIN);
@@ -198,6 +259,7 @@ void playTone(int freq, int duration) {
 unsigned long toneStopAt = 0;               // when to silence the buzzer
 void playToneNB(uint16_t freq, uint16_t ms) // NB = non-blocking
 {
+  TRACE_SCOPE("playToneNB");
   tone(BUZZER_PIN, freq);
   toneStopAt = millis() + ms;
 }
@@ -241,25 +303,153 @@ void updateLEDs()
 }
 
 
+// Tell the pathfinder where the poops are; call whenever they change
+void updatePetAiObstacles() {
+  petAiClearObstacles();
+  for (int i = 0; i < MAX_POOPS; i++) {
+    if (poops[i].active)
+      petAiAddObstacle(poops[i].x, poops[i].y, poopW * poopScale, poopH * poopScale);
+  }
+  petAiObstaclesDone();
+}
+
+
 void spawnPoop() {
   for (int i = 0; i < MAX_POOPS; i++) {
     if (!poops[i].active) {
       poops[i].x = petX;
       poops[i].y = petY;
       poops[i].active = true;
+      updatePetAiObstacles();
+      bgDirty = true;
       break;
     }
   }
 }
 
 
-void handleEatingBounce() {
+// Idle clip for the pet's current mood
+const AnimClip *moodClip() {
+  return (happiness < 30) ? &clipIdleSad : &clipIdleHappy;
+}
+
+
+// Swap idle clips when the mood changes; busy clips are left alone
+void refreshPetMood() {
+  if (petAnim.clip == &clipIdleHappy || petAnim.clip == &clipIdleSad)
+    animPlay(petAnim, moodClip(), 300);
+}
+
+
+void onPetCue(uint8_t cue) {
+  switch (cue) {
+    case CUE_CHOMP_HIGH:
+      playToneNB(1200, 60);
+      particlesEmitCrumbs(petX + petWidth / 2, petY + petHeight * 2 / 3 + petAnim.pose.dy);
+      break;
+    case CUE_CHOMP_LOW:  playToneNB(700,  60); break;
+    case CUE_CHEER:      playToneNB(1800, 50); break;
+  }
+}
+
+
+// Run the game rules over elapsedMs in one go, however long that is
+void advanceRules(unsigned long elapsedMs, bool decayPaused) {
+  TRACE_SCOPE("gameRules");
+  VitalState v = { hunger, happiness, badTicks, dead };
+  RuleOutcome out = advanceGame(gameRules, v, ruleClock, elapsedMs, decayPaused);
+  if (out.ticks) historyRecordTicks(gameRules, hunger, happiness, out.ticks, decayPaused);
+  hunger = v.hunger;
+  happiness = v.happiness;
+  badTicks = v.badTicks;
+  dead = v.dead;
+
+  // spawnPoop() stops once every slot is full
+  for (unsigned long i = 0; i < out.poops && i < (unsigned long)MAX_POOPS; i++) spawnPoop();
+
+  if (out.ticks) refreshPetMood();
+  if (out.died) {
+    for (int i = 0; i < NUM_LEDS; i++) digitalWrite(ledPins[i], LOW);
+    animPlay(petAnim, &clipDying, 0);
+  }
+}
+
+
+// Pack the game into RTC memory and deep sleep until the wheel or
+// select pad is touched; setup() picks it up again via restoreFromSleep()
+void goToSleep() {
+  setLEDs(0);
+  noTone(BUZZER_PIN);
+
+  // fold the time since the last rule step into the save, paused the
+  // same way loop() pauses it mid-meal or mid-play
+  advanceRules(millis() - lastUpdate, isEating || isPlaying);
+  lastUpdate = millis();
+
+  rtcSave.hunger = hunger;
+  rtcSave.happiness = happiness;
+  rtcSave.badTicks = badTicks;
+  rtcSave.dead = dead;
+  rtcSave.moveMode = moveMode;
+  rtcSave.petX = petX;
+  rtcSave.petY = petY;
+  rtcSave.tickPhaseMs = ruleClock.tickPhaseMs;
+  rtcSave.poopPhaseMs = ruleClock.poopPhaseMs;
+  rtcSave.poopMask = 0;
+  for (int i = 0; i < MAX_POOPS && i < SAVED_POOPS; i++) {
+    if (poops[i].active) rtcSave.poopMask |= 1UL << i;
+    rtcSave.poopX[i] = poops[i].x;
+    rtcSave.poopY[i] = poops[i].y;
+  }
+  rtcSave.touchBaseline[0] = baseline0;
+  rtcSave.touchBaseline[1] = baseline1;
+  rtcSave.touchBaseline[2] = baseline2;
+  rtcSave.touchBaseline[3] = baselineSelect;
+  historySave(dead);     // the RTC copy survives sleep; flash only now and then
+
+  const int pins[] = {Q2_TOUCH_PIN, Q1_TOUCH_PIN, Q3_TOUCH_PIN, SELECT_TOUCH_PIN};
+  const uint16_t thresholds[] = {
+    (uint16_t)(baseline0 - TOUCH_ON_DELTA),
+    (uint16_t)(baseline1 - TOUCH_ON_DELTA),
+    (uint16_t)(baseline2 - TOUCH_ON_DELTA),
+    (uint16_t)(baselineSelect - centerThreshold)
+  };
+  sleepEnter(tft, pins, thresholds, 4);
+}
+
+
+// Undo goToSleep() and catch the rules up on the time spent asleep
+void restoreFromSleep() {
+  hunger = rtcSave.hunger;
+  happiness = rtcSave.happiness;
+  badTicks = rtcSave.badTicks;
+  dead = rtcSave.dead;
+  wokeDead = dead;
+  moveMode = rtcSave.moveMode ? DVD_BOUNCE : WANDER;
+  petX = rtcSave.petX;
+  petY = rtcSave.petY;
+  ruleClock.tickPhaseMs = rtcSave.tickPhaseMs;
+  ruleClock.poopPhaseMs = rtcSave.poopPhaseMs;
+  for (int i = 0; i < MAX_POOPS && i < SAVED_POOPS; i++) {
+    poops[i].active = (rtcSave.poopMask >> i) & 1;
+    poops[i].x = rtcSave.poopX[i];
+    poops[i].y = rtcSave.poopY[i];
+  }
+  updatePetAiObstacles();
+  baseline0 = rtcSave.touchBaseline[0];
+  baseline1 = rtcSave.touchBaseline[1];
+  baseline2 = rtcSave.touchBaseline[2];
+  baselineSelect = rtcSave.touchBaseline[3];
+
+  advanceRules(sleepElapsedMs(), false);
+  if (!dead) animPlay(petAnim, moodClip(), 0);
+}
+
+
+// The chomping bounce and its tones come from clipEating
+void handleEating() {
   unsigned long now = millis();
   const unsigned long eatingDuration = 1500; // milliseconds
-  const unsigned long bounceInterval = 200;  // Bounce up/down every X ms
-
-  static bool bounceUp = true;
-  static unsigned long lastBounceTime = 0;
 
   if (now - eatingStartTime >= eatingDuration) {
     isEating = false;  // Done eating
@@ -267,28 +457,29 @@ void handleEatingBounce() {
     hasEatenCurrentFood = false;
     // Decrease hunger
     hunger = max(0, hunger - 16);
-    return;
+    animPlay(petAnim, moodClip(), 150);
   }
+}
 
-  if (now - lastBounceTime >= bounceInterval) {
-    lastBounceTime = now;
-    bounceUp = !bounceUp;
-
-    if (bounceUp) {
-      petY -= 5;
-      playToneNB(1200, 60);
-    } else {
-      petY += 5;
-      playToneNB(700,  60);
-    }
 
-    // Make sure he doesn't wander off sprite field while bouncing
-    petY = constrain(petY, 0, spriteH - petHeight);
-  }
+// Feed the behaviour layer what the pet can see and let it pick a goal
+void thinkPet(unsigned long now) {
+  PetSenses s;
+  s.petX = petX;
+  s.petY = petY;
+  s.foodVisible = foodActive && !hasEatenCurrentFood;
+  s.foodX = foodX + foodW / 2 - petWidth / 2;
+  s.foodY = foodY + foodH / 2 - petHeight / 2;
+  s.ballInPlay = isPlaying;
+  s.ballX = ballX + ballRadius - petWidth / 2;
+  s.ballY = ballY + ballRadius - petHeight / 2;
+  s.happiness = happiness;
+  petAiThink(s, now);
 }
 
 
 void movePet() {
+  TRACE_SCOPE("movePet");
   static unsigned long lastMoveTime = 0;
   const unsigned long moveInterval = 200;
   static unsigned long lastPetBallHitTime = 0;
@@ -299,7 +490,7 @@ void movePet() {
   lastMoveTime = now;
 
   if (isEating) {
-    handleEatingBounce();
+    handleEating();
     return;
   }
 
@@ -313,14 +504,16 @@ void movePet() {
     if (abs(ballVX) < 0.05) ballVX = 0;
     if (abs(ballVY) < 0.05) ballVY = 0;
 
-    // Bounce ball off walls
+    // Bounce ball off walls, kicking up dust on the wall side
     if (ballX <= 0 || ballX >= spriteW - ballDiameter) {
       ballVX = -ballVX;
       ballX = constrain(ballX, 0, spriteW - ballDiameter);
+      particlesEmitDust(ballX <= 0 ? 0 : spriteW - 1, ballY + ballRadius, ballX <= 0 ? 1 : -1, 0);
     }
     if (ballY <= 0 || ballY >= spriteH - ballDiameter) {
       ballVY = -ballVY;
       ballY = constrain(ballY, 0, spriteH - ballDiameter);
+      particlesEmitDust(ballX + ballRadius, ballY <= 0 ? 0 : spriteH - 1, 0, ballY <= 0 ? 1 : -1);
     }
 
     // Pet chases ball
@@ -331,38 +524,43 @@ void movePet() {
 
     int distX = ballCenterX - petCenterX;
     int distY = ballCenterY - petCenterY;
-    int distanceSquared = distX * distX + distY * distY;
-    int collisionDistance = (petWidth / 2) + ballRadius;
-
-    // Handle collision
-    if (distanceSquared < collisionDistance * collisionDistance) {
-      if (now - lastBallHit >= ballHitCooldown) {
-        float angle = atan2(distY, distX);
-        float hitStrength = 5.0 + random(-10, 10) * 0.1;
-        ballVX = cos(angle) * hitStrength;
-        ballVY = sin(angle) * hitStrength;
-        lastBallHit = now;
-      }
+
+    // Handle collision: pet silhouette, where the pose draws it, against
+    // the ball, which leaves along the contact normal. Checked on every
+    // move step outside the cooldown; a miss costs the same as masksOverlap()
+    Contact hit;
+    if (now - lastBallHit >= ballHitCooldown &&
+        masksContact(petMask, petX + petAnim.pose.dx, petY + petAnim.pose.dy,
+                     ballMask, ballX, ballY, hit)) {
+      float hitStrength = 5.0 + random(-10, 10) * 0.1;
+      ballVX = hit.nx * hitStrength;
+      ballVY = hit.ny * hitStrength;
+      lastBallHit = now;
     }
 
     // Only chase ball if enough time passed after last hit
+    thinkPet(now);
     if (now - lastBallHit > ballHitCooldown) {
-      if (abs(distX) > 4) petX += (distX > 0) ? chaseStepBall : -chaseStepBall;
-      if (abs(distY) > 4) petY += (distY > 0) ? chaseStepBall : -chaseStepBall;
+      if (!petAiStep(petX, petY, chaseStepBall)) {
+        // no route planned yet: head straight for it
+        if (abs(distX) > 4) petX += (distX > 0) ? chaseStepBall : -chaseStepBall;
+        if (abs(distY) > 4) petY += (distY > 0) ? chaseStepBall : -chaseStepBall;
+      }
       petX = constrain(petX, 0, spriteW - petWidth);
       petY = constrain(petY, 0, spriteH - petHeight);
     }
 
     // Spin ball ONLY if moving
-    if (ballVX != 0 || ballVY != 0) {
-      ballColorOffset += 30;
-      if (ballColorOffset >= 360) ballColorOffset -= 360;
-    }
+    ballAnim.paused = (ballVX == 0 && ballVY == 0);
 
     // Check if play time expired
     if (millis() - playingStartTime >= playTimeout) {
       isPlaying = false;    // End playing
       happiness = min(100, happiness + 20);  // Reward happiness
+      particlesEmitHearts(petX + petWidth / 2, petY);
+      particlesEmitConfetti(petX + petWidth / 2, petY);
+      animPlay(petAnim, &clipCheer, 100);
+      animQueue(petAnim, moodClip(), 150);
     }
 
     return; // exit early
@@ -374,17 +572,22 @@ void movePet() {
 
     // if (abs(dx) > 2) petX += (dx > 0) ? petDX : -petDX;
     // if (abs(dy) > 2) petY += (dy > 0) ? petDY : -petDY;
-    if (abs(dx) > 2) petX += (dx > 0) ? chaseStepFood : -chaseStepFood;
-    if (abs(dy) > 2) petY += (dy > 0) ? chaseStepFood : -chaseStepFood;
+    thinkPet(now);
+    if (!petAiStep(petX, petY, chaseStepFood)) {
+      // no route planned yet: head straight for it
+      if (abs(dx) > 2) petX += (dx > 0) ? chaseStepFood : -chaseStepFood;
+      if (abs(dy) > 2) petY += (dy > 0) ? chaseStepFood : -chaseStepFood;
+    }
 
     petX = constrain(petX, 0, spriteW - petWidth);
     petY = constrain(petY, 0, spriteH - petHeight);
 
-    if (abs((foodX + foodW / 2) - (petX + petWidth / 2)) < 8 &&
-        abs((foodY + foodH / 2) - (petY + petHeight / 2)) < 8) {
+    if (masksOverlap(petMask, petX + petAnim.pose.dx, petY + petAnim.pose.dy,
+                     foodMask, foodX, foodY)) {
       isEating = true;
       eatingStartTime = millis();
       hasEatenCurrentFood = true;
+      animPlay(petAnim, &clipEating, 100);
     }
     return;
   }
@@ -397,17 +600,9 @@ void movePet() {
     if (petX <= 0 || petX >= spriteW - petWidth) petDX = -petDX;
     if (petY <= 0 || petY >= spriteH - petHeight) petDY = -petDY;
   } else {
-    int dx = random(-1, 2);
-    int dy = random(-1, 2);
-
-    if (petX <= 10) dx = 1;
-    else if (petX >= spriteW - petWidth - 10) dx = -1;
-
-    if (petY <= 10) dy = 1;
-    else if (petY >= spriteH - petHeight - 10) dy = -1;
-
-    petX += dx * wanderStep;
-    petY += dy * wanderStep;
+    // stroll between random spots, stepping around poops
+    thinkPet(now);
+    petAiStep(petX, petY, wanderStep);
 
     petX = constrain(petX, 0, spriteW - petWidth);
     petY = constrain(petY, 0, spriteH - petHeight);
@@ -431,6 +626,8 @@ void applyAction() {
     ballY = random(20, spriteH - ballDiameter - 20);
     ballVX = 0;  // Reset velocity
     ballVY = 0;
+    animPlay(petAnim, &clipPlaying, 100);
+    animPlay(ballAnim, &clipBallSpin, 0);
     playTone(2000, 100);
 
   } else if (currentMenuIndex == 2 && !dead) {
@@ -438,37 +635,21 @@ void applyAction() {
     for (int i = 0; i < MAX_POOPS; i++) {
       poops[i].active = false;
     }
+    updatePetAiObstacles();
+    bgDirty = true;
     playTone(2000, 100);
   }
 }
 
 
 void drawHUD() {
-  tft.setTextSize(2);
-  tft.setCursor(10, 2);
-
-  int fullHearts = (100 - (hunger / 2) - (50 - happiness / 2)) / 20;
-  for (int i = 0; i < 5; i++) {
-    tft.setTextColor((i < fullHearts) ? TFT_RED : TFT_DARKGREY, TFT_BLACK);
-    tft.print("\x03 ");
-  }
-
-  // tft.setCursor(160, 3);
-  // tft.setTextColor(TFT_WHITE, TFT_BLACK);
-  // tft.print(hunger);
-
-  tft.setCursor(200, 3);
-  tft.setTextColor(TFT_WHITE, TFT_BLACK);
-  if (happiness > 66)
-    tft.print(":)");
-  else if (happiness > 33)
-    tft.print(":|");
-  else
-    tft.print(":(");
+  TRACE_SCOPE("drawHUD");
+  drawHudBar(tft, hunger, happiness);
 }
 
 
 void drawButtons() {
+  TRACE_SCOPE("drawButtons");
   static int previousMenuIndex = -1;
   
   if (currentMenuIndex == previousMenuIndex) {
@@ -476,80 +657,22 @@ void drawButtons() {
     return;
   }
   
-  const char* labels[] = {"Feed", "Play", "Clean"};
-  int buttonWidth = 240 / 3;
-  tft.setTextSize(2);
-
-  for (int i = 0; i < 3; i++) {
-    int x = i * buttonWidth;
-    if (i == currentMenuIndex) {
-      tft.fillRect(x, buttonY, buttonWidth, buttonAreaHeight, TFT_YELLOW);
-      tft.setTextColor(TFT_BLACK, TFT_YELLOW);
-    } else {
-      tft.fillRect(x, buttonY, buttonWidth, buttonAreaHeight, TFT_WHITE);
-      tft.setTextColor(TFT_BLACK, TFT_WHITE);
-    }
-    int textX = x + (buttonWidth / 2) - (strlen(labels[i]) * 6);
-    tft.setCursor(textX, buttonY + 10);
-    tft.print(labels[i]);
-  }
+  drawMenuButtons(tft, currentMenuIndex);
 
   previousMenuIndex = currentMenuIndex;  // Update after draw
 }
 
 
-//------------------------------------------------------------------
-// Universal 1-bpp scaler: works with TFT_eSPI *and* TFT_eSprite
-//------------------------------------------------------------------
-template <class GFX>     // GFX = TFT_eSPI or TFT_eSprite
-void drawScaledBitmap1bpp(
-        GFX           &dst,            // where to draw (screen or sprite)
-        const uint8_t *bitmap,         // PROGMEM 1-bpp image
-        int            X,  int Y,      // top-left unless centered*
-        int            Width, 
-        int            Height,
-        int            Scale,          // integer ≥1
-        uint16_t       fgColor,
-        uint16_t       bgColor,
-        bool           transparentBg = true,
-        bool           centeredX      = false,
-        bool           centeredY      = false
-  ) {
-    if (centeredX) X = (dst.width()  - Width  * Scale) >> 1;
-    if (centeredY) Y = (dst.height() - Height * Scale) >> 1;
-
-    const int rowBytes = (Width + 7) >> 3;
-
-    for (int row = 0; row < Height; ++row) {
-        for (int col = 0; col < Width; ++col) {
-            int byteIdx = row * rowBytes + (col >> 3);
-            uint8_t  mask = 0x80 >> (col & 7);
-            bool bitOn = pgm_read_byte(&bitmap[byteIdx]) & mask;
-
-            if (bitOn || !transparentBg) {
-                uint16_t c = bitOn ? fgColor : bgColor;
-                int x0 = X + col * Scale;
-                int y0 = Y + row * Scale;
-                if (Scale == 1) dst.drawPixel(x0, y0, c);
-                else            dst.fillRect(x0, y0, Scale, Scale, c);
-            }
-        }
-    }
-}
-
-
-void drawPoops() {
+void drawPoops(TFT_eSprite &dst) {
+  TRACE_SCOPE("drawPoops");
   for (int i = 0; i < 25; i++) {
     if (poops[i].active) {
-      drawScaledBitmap1bpp(
-        petLayer,             // draw into the sprite
-        poop_bitmap,
-        poops[i].x, poops[i].y,  
-        poopW, poopH,         // original size
+      drawSprite(
+        dst,                  // draw into the sprite
+        poop_bitmap_sprite,
+        poops[i].x, poops[i].y,
         poopScale,            // scale
-        TFT_BROWN,            // fg color
-        TFT_BLACK,            // bg color (ignored when transparent=true)
-        true                  // transparent background
+        TFT_BROWN             // fg color
       );
     }
   }
@@ -557,49 +680,64 @@ void drawPoops() {
 
 
 void drawBeachBall(int x, int y) {
-  int r = ballRadius;
-  int centerX = x + r;
-  int centerY = y + r;
+  TRACE_SCOPE("drawBeachBall");
+  // slices only while the frame budget allows
+  drawBall(petLayer, x, y, ballAnim.pose.frame, !qualityAtLeast(QUALITY_PLAIN_BALL));
+}
 
-  // Draw base white circle
-  petLayer.fillCircle(centerX, centerY, r, TFT_WHITE);
 
-  // Now draw rotated slices
-  int numSlices = 4;  // red, yellow, blue, green
-  int sliceAngle = 360 / numSlices;
+void drawPetFace(const SpriteView &face, int x, int y,
+                 int scale = petScale, uint16_t color = TFT_WHITE,
+                 TFT_eSprite &dst = petLayer) {
+    TRACE_SCOPE("drawPetFace");
+    drawSprite(
+        dst,                  // draw into the sprite
+        face,
+        x, y,
+        scale,                // scale
+        color                 // fg color
+    );
+}
 
-  uint16_t sliceColors[] = {TFT_RED, TFT_YELLOW, TFT_BLUE, TFT_GREEN};
 
-  for (int i = 0; i < numSlices; i++) {
-    float angleDeg = ballColorOffset + i * sliceAngle;
-    float angleRad = angleDeg * PI / 180.0;
+// Draw the pet as its animation player currently poses it
+void drawPetPose(TFT_eSprite &dst = petLayer) {
+  const AnimPose &p = petAnim.pose;
+  int scale = p.scale ? p.scale : petScale;
+  drawPetFace(*petFrames[p.frame], petX + p.dx, petY + p.dy,
+              scale, animPalette[p.palette], dst);
+  if (&dst == &petLayer)
+    layersMarkDirty(petX + p.dx, petY + p.dy,
+                    petBitmapWidth * scale, petBitmapHeight * scale);
+}
 
-    int sliceX = centerX + (r / 2) * cos(angleRad);
-    int sliceY = centerY + (r / 2) * sin(angleRad);
 
-    petLayer.fillCircle(sliceX, sliceY, r / 2, sliceColors[i]);
-  }
+void drawGrave(TFT_eSprite &dst) {
+  TRACE_SCOPE("drawGrave");
+  drawGraveStone(dst);
+}
 
-  // Center dot
-  petLayer.fillCircle(centerX, centerY, 3, TFT_WHITE);
 
-  // outer border
-  petLayer.drawCircle(centerX, centerY, r, TFT_BLACK);
+// Re-render the static layer and copy it under the dynamic one.
+// Only runs when poops change or the grave goes up, so the per-frame
+// cost no longer grows with the number of poops on screen.
+void renderBackground() {
+  TRACE_SCOPE("renderBackground");
+  bgLayer.fillSprite(TFT_BLACK);
+  drawPoops(bgLayer);
+  if (graveUp) {
+    drawPetPose(bgLayer);
+    drawGrave(bgLayer);
+  }
+  layersRestoreAll();
+  bgDirty = false;
 }
 
 
-void drawPetFace(const uint8_t *bmp, int x, int y) {
-    drawScaledBitmap1bpp(
-        petLayer,             // draw into the sprite
-        bmp,
-        x, y,
-        // 16, 16,               
-        petBitmapWidth, petBitmapHeight, // original size
-        petScale,             // scale
-        TFT_WHITE,            // fg color
-        TFT_BLACK,            // bg color (ignored when transparent=true)
-        true                  // transparent background
-    );
+// Clear last frame's dynamic drawing back to the cached background
+void restoreBackground() {
+  if (bgDirty) renderBackground();
+  else layersRestore();
 }
 
 
@@ -623,124 +761,123 @@ void drawPetFace(const uint8_t *bmp, int x, int y) {
 
 
 void handleDeath() {
+  TRACE_SCOPE("handleDeath");
+  governorSkipFrame();   // dying clip and tones block
   // petLayer.fillSprite(TFT_BLACK); // Clear background
 
-  drawPetFace(pet_dead, petX, petY);
-
-  // Draw the grave scaled
-  drawScaledBitmap1bpp(petLayer,
-                     grave_back_bitmap,
-                     0, 0, graveW, graveH, graveScale,
-                     TFT_DARKGREY, TFT_BLACK, true,
-                     true, true      // centred X & Y
-  );
-  drawScaledBitmap1bpp(petLayer,
-                      grave_rip_bitmap,
-                      0, 0, graveW, graveH, graveScale,
-                      TFT_WHITE, TFT_BLACK, true, 
-                      true, true      // centred X & Y
-  );
+  // Play the dying clip through before the grave goes up
+  if (!wokeDead) {
+    unsigned long last = millis();
+    while (petAnim.clip == &clipDying && petAnim.t < clipDying.length) {
+      unsigned long now = millis();
+      animUpdateAll(now - last);
+      last = now;
+      restoreBackground();
+      drawPetPose();
+      petLayer.pushSprite(0, spriteY);
+      delay(frameInterval / 2);
+    }
+  }
 
-  petLayer.pushSprite(0, spriteY);
+  if (wokeDead) {
+    animPlay(petAnim, &clipDying, 0);
+    animUpdateAll(clipDying.length);   // straight to the final pose
+  }
 
-  // Death Sounds
-  playTone(400, 300);
-  delay(100);
-  playTone(300, 300);
-  delay(100);
-  playTone(200, 600);
+  // The dead pet and grave never move again; bake them into the background
+  graveUp = true;
+  renderBackground();
 
-  while (true) {
-    // Freeze the game
+  {
+    TRACE_SCOPE("pushSprite");
+    petLayer.pushSprite(0, spriteY);
   }
+  sleepMarkFirstFrame();
+
+  // Death Sounds, unless we already played them before sleeping
+  if (!wokeDead) {
+    playTone(400, 300);
+    delay(100);
+    playTone(300, 300);
+    delay(100);
+    playTone(200, 600);
+  }
+
+#ifdef THOT_SERIAL_LINK
+  // A test rig keeps the badge up on the grave so the link survives;
+  // LINK_SET_STATE without the dead flag brings the pet back
+  return;
+#endif
+  // Leave the grave up for a while, then power down instead of spinning
+  delay(deathScreenTime);
+  goToSleep();
 }
 
 
 void drawUI() {
-  petLayer.fillSprite(TFT_BLACK);
+  TRACE_SCOPE("drawUI");
+  restoreBackground();
 
   drawHUD();
-  drawPoops();
 
   if (dead) {
-    handleDeath();
-  } else if (happiness < 30) {
-    drawPetFace(pet_sad, petX, petY);
+    if (!graveUp) handleDeath();    // only returns in link builds
   } else {
-    drawPetFace(pet_happy, petX, petY);
+    drawPetPose();
   }
 
   if (foodActive && !hasEatenCurrentFood) {
-    drawScaledBitmap1bpp(
+    TRACE_SCOPE("drawFood");
+    drawSprite(
         petLayer,        // draw into the sprite
-        food_bitmap,
+        food_bitmap_sprite,
         foodX, foodY,
-        foodW, foodH,    // original size
         foodScale,       // scale
-        TFT_ORANGE,      // fg color
-        TFT_BLACK,       // bg color (ignored when transparent=true)
-        true             // transparent background
+        TFT_ORANGE       // fg color
       );
+    layersMarkDirty(foodX, foodY, foodW * foodScale, foodH * foodScale);
   }
 
   if (isPlaying) {
     drawBeachBall(ballX, ballY);  // Always draw every frame
+    layersMarkDirty(ballX, ballY, ballDiameter + 1, ballDiameter + 1);
   }
 
+  particlesDraw((uint8_t *)petLayer.getPointer(), spriteW, spriteH);
+  ParticleBox boxes[PARTICLE_GROUPS];
+  int nBoxes = particlesBounds(boxes);
+  for (int i = 0; i < nBoxes; i++)
+    layersMarkDirty(boxes[i].x0, boxes[i].y0, boxes[i].x1 - boxes[i].x0, boxes[i].y1 - boxes[i].y0);
+
   drawButtons();
   // petLayer.drawRect(0, 0, spriteW, spriteH, TFT_GREEN); // Debugging Green frame
+  TRACE_SCOPE("pushSprite");
   petLayer.pushSprite(0, spriteY);
+  sleepMarkFirstFrame();
 }
 
 
-void showSplashScreen() {
-  tft.fillScreen(TFT_BLACK);
-  tft.setTextSize(3);
-
-  const char* title = "THoTaGoTcHi";
-  // Rainbow palette (extended ROYGBIV: 11 evenly-spaced hues)
-  uint16_t titleColors[11] = {
-    TFT_RED,         // Red
-    TFT_ORANGE,      // Red-Orange
-    TFT_YELLOW,      // Yellow
-    TFT_GREENYELLOW, // Yellow-Green
-    TFT_GREEN,       // Green
-    TFT_CYAN,        // Green-Blue
-    TFT_BLUE,        // Blue
-    TFT_NAVY,        // Indigo
-    TFT_PURPLE,      // Violet
-    TFT_MAGENTA,     // Violet-Magenta
-    TFT_PINK         // Pink (tail of spectrum)
-  };
+// Vitals trend graph over the play field until Center is tapped again.
+// The game is frozen meanwhile; the rules catch up on return.
+void showHistory() {
+  TRACE_SCOPE("showHistory");
+  governorSkipFrame();   // waits on the user
+  historyDrawGraph(petLayer, spriteW, spriteH);
+  petLayer.pushSprite(0, spriteY);
+  playTone(2000, 100);
 
-  for (int i = 0; i < strlen(title); i++) {
-    tft.setTextColor(titleColors[i % (sizeof(titleColors) / sizeof(titleColors[0]))], TFT_BLACK);
-    tft.setCursor(25 + i * 18, 30);
-    tft.print(title[i]);
-  }
-
-  // Draw egg
-  drawScaledBitmap1bpp(
-    tft,
-    egg_bitmap,
-    0, 80,           // X, Y on screen
-    eggW, eggH,      // Width, Height
-    eggScale,        // Scale
-    TFT_GOLD,        // foreground (‘1’ bits)
-    TFT_BLACK,       // background (optional)
-    true,            // transparent background
-    true,            // Centered X
-    false            // Centered Y
-  );
-
-  tft.setTextSize(2);
-  tft.setTextColor(TFT_CYAN, TFT_BLACK);
-  tft.setCursor(50, 170);
-  tft.println("Made by Kujo");
-  tft.setCursor(105, 190);
-  tft.println("for");
-  tft.setCursor(55, 210);
-  tft.println("THOTCON 0xD");
+  unsigned long shownAt = millis();
+  while (isCenterPressed()) delay(20);          // let go of the long press
+  while (!isCenterPressed() && millis() - shownAt < historyScreenTime) delay(20);
+  while (isCenterPressed()) delay(20);
+
+  renderBackground();     // the graph covered the whole field
+  lastTouchTime = millis();
+}
+
+
+void showSplashScreen() {
+  drawSplashPage(tft);
 
   // play startup tune
   playTone(880, 100);   // A5
@@ -768,34 +905,184 @@ void showSplashScreen() {
   tft.fillScreen(TFT_BLACK);
 }
 
+#ifdef THOT_SERIAL_LINK
+//-----------------------------------------------------------
+// Serial link command handling and telemetry
+
+void sendLinkState() {
+  LinkState st;
+  st.ms = millis();
+  st.hunger = hunger;
+  st.happiness = happiness;
+  st.badTicks = badTicks;
+  st.flags = (dead ? LINK_FLAG_DEAD : 0) |
+             (moveMode == DVD_BOUNCE ? LINK_FLAG_DVD : 0) |
+             (isEating ? LINK_FLAG_EATING : 0) |
+             (isPlaying ? LINK_FLAG_PLAYING : 0) |
+             (foodActive ? LINK_FLAG_FOOD : 0);
+  st.petX = petX;
+  st.petY = petY;
+  st.poops = 0;
+  for (int i = 0; i < MAX_POOPS; i++) st.poops += poops[i].active;
+  st.menu = currentMenuIndex;
+  st.rxBad = linkStats.rxBad;
+  st.txDropped = linkStats.txDropped;
+  linkSend(LINK_STATE, &st, sizeof(st));
+}
+
+
+void onLinkFrame(uint8_t type, const uint8_t *payload, uint8_t len) {
+  lastTouchTime = millis();     // a rig driving the badge keeps it awake
+  bool ok = true;
+
+  if (type == LINK_PING) {
+    linkSend(LINK_PONG, payload, len);
+    return;
+
+  } else if (type == LINK_WHEEL && len >= sizeof(LinkWheel)) {
+    LinkWheel w;
+    memcpy(&w, payload, sizeof(w));
+    linkWheelAngle = (w.angle < 0) ? -1 : w.angle % 360;
+
+  } else if (type == LINK_CENTER && len >= sizeof(LinkCenter)) {
+    linkCenter = payload[0] != 0;
+
+  } else if (type == LINK_SET_STATE && len >= sizeof(LinkSetState)) {
+    LinkSetState st;
+    memcpy(&st, payload, sizeof(st));
+    hunger = constrain(st.hunger, 0, maxHunger);
+    happiness = constrain(st.happiness, 0, maxHappiness);
+    badTicks = st.badTicks;
+    dead = st.flags & LINK_FLAG_DEAD;
+    moveMode = (st.flags & LINK_FLAG_DVD) ? DVD_BOUNCE : WANDER;
+    for (int i = 0; i < MAX_POOPS; i++) {
+      poops[i].active = i < st.poops;
+      poops[i].x = random(0, spriteW - poopW * poopScale);
+      poops[i].y = random(0, spriteH - poopH * poopScale);
+    }
+    updatePetAiObstacles();
+    graveUp = false;              // handleDeath() puts it back if still dead
+    bgDirty = true;
+    // exactly the state the host set: nothing eaten, played or pending,
+    // and a face to match (refreshPetMood() leaves clipDying alone)
+    isEating = false;
+    isPlaying = false;
+    foodActive = false;
+    hasEatenCurrentFood = false;
+    animPlay(petAnim, dead ? &clipDying : moodClip(), 0);
+
+  } else if (type == LINK_WARP && len >= sizeof(LinkWarp)) {
+    LinkWarp w;
+    memcpy(&w, payload, sizeof(w));
+    advanceRules(w.ms, false);
+
+  } else if (type == LINK_ACTION && len >= sizeof(LinkAction) && payload[0] <= 2) {
+    // same path as a center tap on the wheel
+    currentMenuIndex = payload[0];
+    drawButtons();
+    applyAction();
+
+  } else if (type == LINK_STREAM && len >= sizeof(LinkStream)) {
+    LinkStream st;
+    memcpy(&st, payload, sizeof(st));
+    linkStreamMask = st.mask;
+    linkStatePeriod = st.statePeriodMs;
+
+  } else {
+    ok = false;
+  }
+
+  LinkAck ack = {type, ok};
+  linkSend(LINK_ACK, &ack, sizeof(ack));
+  if (ok && type != LINK_STREAM) sendLinkState();
+}
+
+
+// Per-frame telemetry, after the governor has seen the frame
+void serviceLinkTelemetry() {
+  if (linkStreamMask & LINK_STREAM_FRAMES) {
+    LinkFrameTiming ft;
+    ft.frame = governorStats.frames;
+    ft.simUs = governorStats.lastSimUs;
+    ft.drawUs = governorStats.lastDrawUs;
+    ft.restoreUs = min<uint32_t>(layerStats.restoreUs, 0xFFFF);
+    ft.particles = particleStats.live;
+    ft.quality = governorStats.level;
+    ft.misses = governorStats.misses;
+    ft.planUs = min<uint32_t>(petAiStats.planUsLastFrame, 0xFFFF);
+    ft.expansions = petAiStats.expansionsLastFrame;
+    ft.particleUpdateUs = min<uint32_t>(particleStats.updateUs, 0xFFFF);
+    ft.particleDrawUs = min<uint32_t>(particleStats.drawUs, 0xFFFF);
+    linkSend(LINK_FRAME, &ft, sizeof(ft));
+  }
+  if ((linkStreamMask & LINK_STREAM_STATE) && linkStatePeriod &&
+      millis() - lastLinkState >= linkStatePeriod) {
+    lastLinkState = millis();
+    sendLinkState();
+  }
+}
+#endif
+
 //-----------------------------------------------------------
 
 void setup() {
   // Serial.begin(115200);
   // delay(1000);
+  TRACE_BEGIN();
+#ifdef THOT_SERIAL_LINK
+  linkBegin(onLinkFrame);
+#endif
   tft.init();
   tft.setRotation(0);
   tft.fillScreen(TFT_BLACK);
   petLayer.createSprite(spriteW, spriteH);
   petLayer.setColorDepth(8);
+  bgLayer.createSprite(spriteW, spriteH);
+  bgLayer.setColorDepth(8);
+  layersInit((uint8_t *)bgLayer.getPointer(), (uint8_t *)petLayer.getPointer(),
+             spriteW, spriteH);
 
   pinMode(BUZZER_PIN, OUTPUT);
   for (int i = 0; i < NUM_LEDS; i++) pinMode(ledPins[i], OUTPUT);
 
-  calibrateTouch();
-  showSplashScreen();
+  petAiInit(spriteW - petWidth, spriteH - petHeight, petWidth, petHeight);
+  animRegister(petAnim, onPetCue);
+  animRegister(ballAnim, NULL);
+  animPlay(petAnim, &clipIdleHappy, 0);
+  historyInit(hunger, happiness);     // before restoreFromSleep() records the sleep
+  if (sleepWokeWithSave()) {
+    // straight back to the game: no calibration, no splash
+    restoreFromSleep();
+    // a wake from the select pad is still being held; it isn't a tap
+    wasCenterPressed = isCenterPressed();
+  } else {
+    calibrateTouch();
+    showSplashScreen();
+  }
   drawButtons();
 
   lastFrameTime = millis(); 
   lastUpdate = millis();
-  lastPoopCheck = millis();
+  lastTouchTime = millis();
+  lastAnimTime = millis();
+  lastParticleTime = millis();
 }
 
 
 void loop() {
+  TRACE_SCOPE("loop");
+  TRACE_SERVICE();    // answer host trace dump requests
+  unsigned long loopStartUs = micros();
+#ifdef THOT_SERIAL_LINK
+  linkService();      // host commands land before input is read
+#endif
   serviceTone();      // <-- keep buzzer non-blocking
 
   unsigned long now = millis();
+  animUpdateAll(min(now - lastAnimTime, 1000UL));
+  lastAnimTime = now;
+  particlesUpdate(now - lastParticleTime);
+  lastParticleTime = now;
 
   /* -----------------------------------------
    Pause hunger / happiness decay while
@@ -806,6 +1093,7 @@ void loop() {
   // Touch processing
   float wheelAngle;
   if (!dead && readTouchWheelAngle(wheelAngle)) {
+    lastTouchTime = now;
     int newMenuIndex;
     if (wheelAngle > 45 && wheelAngle <= 135) newMenuIndex = 2; // right
     else if (wheelAngle > 135 && wheelAngle <= 225) newMenuIndex = 1; // down
@@ -816,51 +1104,40 @@ void loop() {
       currentMenuIndex = newMenuIndex;
       drawButtons();
     }
+  }
   
-  if (currentMenuIndex == 3 && isCenterPressed()) {
+  bool centerPressed = isCenterPressed();
+  if (centerPressed) lastTouchTime = now;
+  if (!dead && currentMenuIndex == 3) {
+    // Up + Center: a tap toggles the movement mode, a long hold opens
+    // the history graph
+    if (centerPressed && !wasCenterPressed) upHoldStart = now;
+    if (centerPressed && upHoldStart && now - upHoldStart >= historyHoldTime) {
+      upHoldStart = 0;
+      showHistory();
+      centerPressed = false;
+    } else if (!centerPressed && wasCenterPressed && upHoldStart) {
+      upHoldStart = 0;
       moveMode = (moveMode == WANDER) ? DVD_BOUNCE : WANDER;
       playTone(2000, 100);
     }
-  }
-  
-  bool centerPressed = isCenterPressed();
-  if (!dead && centerPressed && !wasCenterPressed && currentMenuIndex != 3) {
-    applyAction();
+  } else {
+    upHoldStart = 0;
+    if (!dead && centerPressed && !wasCenterPressed) applyAction();
   }
   wasCenterPressed = centerPressed;
   
   
   if (!dead) {
-    if (now - lastUpdate >= gameTickInterval) {
-      lastUpdate += gameTickInterval;
-      
-      /* Freeze decay while eating or playing */
-      if (!decayPaused) {
-        hunger = min(maxHunger, hunger + hungerDecay);
-        happiness = max(0, happiness - happinessDecay);
-      }
+    /* Hunger, happiness, death watch and poops; decay is
+       frozen while eating or playing */
+    advanceRules(now - lastUpdate, decayPaused);
+    lastUpdate = now;
 
-      // Serial.print("Hunger: ");
-      // Serial.print(hunger);
-      // Serial.print("  Happiness: ");
-      // Serial.println(happiness);
-      
-      // death-watch counter
-      if (hunger >= 100 && happiness <= 0) badTicks++;
-      else badTicks = 0;
-      
-      if (badTicks >= deathThreshold) {
-        dead = true;
-        for (int i = 0; i < NUM_LEDS; i++) digitalWrite(ledPins[i], LOW);
-      }
-    }
-    
-    if (now - lastPoopCheck > poopCheckInterval) {
-      if (hunger > 80 || happiness < 20 || hunger < 15) {
-        spawnPoop();
-      }
-      lastPoopCheck = now;
-    }
+    // Serial.print("Hunger: ");
+    // Serial.print(hunger);
+    // Serial.print("  Happiness: ");
+    // Serial.println(happiness);
 
     if (!isEating && !isPlaying && !foodActive) {
       if (now - lastIdleChirp > idleChirpCheckInterval) {
@@ -872,6 +1149,17 @@ void loop() {
     }
 
 
+    // stink lines over every poop, unless the frame budget is tight
+    if (now - lastStinkTime >= stinkInterval && !qualityAtLeast(QUALITY_NO_AMBIENT)) {
+      lastStinkTime = now;
+      for (int i = 0; i < MAX_POOPS; i++) {
+        if (poops[i].active) particlesEmitStink(poops[i].x + poopW * poopScale / 2, poops[i].y);
+      }
+    }
+
+    // resume pathfinding within its slice of the frame
+    petAiPlan(aiPlanBudgetUs);
+
     if (now - lastFrameTime >= frameInterval) {
       lastFrameTime += frameInterval;
       movePet();
@@ -879,5 +1167,20 @@ void loop() {
     }
   }
 
-  drawUI();
+  // Render at the frame budget's pace (halved under heavy load); everything
+  // above runs every loop, so input is never stuck behind a slow frame
+  if (now - lastRenderTime >= governorBudgetUs() / 1000) {
+    lastRenderTime = now;
+    unsigned long drawStartUs = micros();
+    drawUI();
+    if (governorFrame(drawStartUs - loopStartUs, micros() - drawStartUs))
+      particlesSetBudget(qualityAtLeast(QUALITY_FEW_PARTICLES) ? MAX_PARTICLES / 4 : MAX_PARTICLES);
+    petAiFrameDone();
+    particlesFrameDone();
+#ifdef THOT_SERIAL_LINK
+    serviceLinkTelemetry();
+#endif
+  }
+
+  if (millis() - lastTouchTime >= sleepAfterIdle) goToSleep();
 }
@@ -0,0 +1,220 @@
+/* Batched particles.
+   Live particles are kept packed at the front of each array; a dead one
+   is replaced by the last live one, so update and draw are straight loops
+   over [0, count) with no per-particle liveness test.
+   Each burst joins the group of an earlier burst emitted close by, or
+   starts a new one; the groups give the dirty boxes. When every group is
+   taken the burst joins the nearest, which only makes that box bigger.
+*/
+
+#include "particles.h"
+#include "trace.h"
+
+const int PARTICLE_STEP_MS = 32;
+const int GROUP_RADIUS = 32;             // px, Manhattan, to join a group
+
+ParticleStats particleStats;
+
+// Structure of arrays; positions and velocities are Q4 (1/16 px)
+static int16_t px[MAX_PARTICLES], py[MAX_PARTICLES];
+static int8_t  vx[MAX_PARTICLES], vy[MAX_PARTICLES];
+static int8_t  ay[MAX_PARTICLES];        // Q4 px per step^2
+static uint8_t life[MAX_PARTICLES];      // steps left
+static uint8_t color[MAX_PARTICLES];     // RGB332
+static uint8_t size[MAX_PARTICLES];      // 1 or 2 px square
+static uint8_t group[MAX_PARTICLES];
+
+static int16_t groupX[PARTICLE_GROUPS], groupY[PARTICLE_GROUPS];   // first burst
+static uint16_t groupLive[PARTICLE_GROUPS];
+
+static int count = 0;
+static int budget = MAX_PARTICLES;
+static unsigned long stepCarryMs = 0;
+static uint32_t updateUsFrame = 0;       // particlesUpdate() since the last frame
+static uint32_t rng = 0x2545F491;
+
+
+// xorshift32; cheaper than random() for per-particle jitter
+static uint32_t nextRand() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+// uniform in [lo, hi]
+static int randRange(int lo, int hi) {
+  return lo + (int)(nextRand() % (uint32_t)(hi - lo + 1));
+}
+
+
+// Group for a burst from (x, y)
+static int pickGroup(int x, int y) {
+  int best = 0, bestDist = 0x7FFF, unused = -1;
+  for (int g = 0; g < PARTICLE_GROUPS; g++) {
+    if (!groupLive[g]) {
+      if (unused < 0) unused = g;
+      continue;
+    }
+    int d = abs(x - groupX[g]) + abs(y - groupY[g]);
+    if (d < bestDist) {
+      best = g;
+      bestDist = d;
+    }
+  }
+  if (bestDist > GROUP_RADIUS && unused >= 0) {
+    groupX[unused] = x;
+    groupY[unused] = y;
+    return unused;
+  }
+  return best;
+}
+
+
+static void emit(int g, int x, int y, int dx, int dy, int accel, int steps, uint8_t c, uint8_t s) {
+  if (count >= budget) {
+    particleStats.dropped++;
+    return;
+  }
+  int i = count++;
+  px[i] = x << 4;
+  py[i] = y << 4;
+  vx[i] = dx;
+  vy[i] = dy;
+  ay[i] = accel;
+  life[i] = steps;
+  color[i] = c;
+  size[i] = s;
+  group[i] = g;
+  groupLive[g]++;
+  if (count > particleStats.peak) particleStats.peak = count;
+}
+
+
+void particlesSetBudget(int maxLive) {
+  budget = constrain(maxLive, 0, MAX_PARTICLES);
+}
+
+
+void particlesEmitCrumbs(int x, int y) {
+  int g = pickGroup(x, y);
+  for (int i = 0; i < 10; i++)
+    emit(g, x + randRange(-4, 4), y, randRange(-20, 20), randRange(-40, -16), 6,
+         randRange(8, 14), (i & 1) ? PCOL_ORANGE : PCOL_BROWN, 1);
+}
+
+
+void particlesEmitHearts(int x, int y) {
+  int g = pickGroup(x, y);
+  for (int i = 0; i < 6; i++)
+    emit(g, x + randRange(-16, 16), y + randRange(-4, 4), randRange(-6, 6), randRange(-14, -8), 0,
+         randRange(16, 24), (i & 1) ? PCOL_RED : PCOL_PINK, 2);
+}
+
+
+void particlesEmitConfetti(int x, int y) {
+  static const uint8_t colors[] = {PCOL_RED, PCOL_YELLOW, PCOL_GREEN, PCOL_BLUE, PCOL_PINK, PCOL_WHITE};
+  int g = pickGroup(x, y);
+  for (int i = 0; i < 48; i++)
+    emit(g, x + randRange(-8, 8), y, randRange(-40, 40), randRange(-64, -24), 4,
+         randRange(16, 30), colors[i % 6], 1 + (i & 1));
+}
+
+
+void particlesEmitStink(int x, int y) {
+  emit(pickGroup(x, y), x + randRange(-6, 6), y, randRange(-4, 4), randRange(-10, -6), 0,
+       randRange(10, 16), PCOL_OLIVE, 1);
+}
+
+
+void particlesEmitDust(int x, int y, int dirX, int dirY) {
+  int g = pickGroup(x, y);
+  for (int i = 0; i < 6; i++)
+    emit(g, x, y, dirX * randRange(4, 16) + randRange(-6, 6), dirY * randRange(4, 16) + randRange(-6, 6),
+         0, randRange(5, 9), PCOL_GREY, 1);
+}
+
+
+static void step() {
+  for (int i = 0; i < count; ) {
+    if (--life[i] == 0) {
+      // swap-remove keeps the arrays packed
+      groupLive[group[i]]--;
+      int last = --count;
+      px[i] = px[last]; py[i] = py[last];
+      vx[i] = vx[last]; vy[i] = vy[last];
+      ay[i] = ay[last]; life[i] = life[last];
+      color[i] = color[last]; size[i] = size[last];
+      group[i] = group[last];
+      continue;
+    }
+    px[i] += vx[i];
+    py[i] += vy[i];
+    vy[i] = constrain(vy[i] + ay[i], -127, 127);
+    i++;
+  }
+}
+
+
+void particlesUpdate(unsigned long dtMs) {
+  TRACE_SCOPE("particlesUpdate");
+  unsigned long start = micros();
+
+  stepCarryMs += dtMs;
+  unsigned long due = stepCarryMs / PARTICLE_STEP_MS;
+  int steps = min<unsigned long>(due, 4);   // don't spiral after a stall
+  // after a stall the time is dropped; otherwise the remainder carries
+  stepCarryMs = (due > 4) ? 0 : stepCarryMs % PARTICLE_STEP_MS;
+  while (steps--) step();
+
+  particleStats.live = count;
+  updateUsFrame += micros() - start;
+}
+
+
+void particlesFrameDone() {
+  particleStats.updateUs = updateUsFrame;
+  updateUsFrame = 0;
+}
+
+
+void particlesDraw(uint8_t *buf, int w, int h) {
+  TRACE_SCOPE("particlesDraw");
+  unsigned long start = micros();
+
+  for (int i = 0; i < count; i++) {
+    int x = px[i] >> 4, y = py[i] >> 4;
+    // one unsigned compare per axis covers both edges
+    if ((unsigned)x >= (unsigned)(w - 1) || (unsigned)y >= (unsigned)(h - 1)) continue;
+    uint8_t *p = buf + y * w + x;
+    uint8_t c = color[i];
+    p[0] = c;
+    if (size[i] > 1) {
+      p[1] = c;
+      p[w] = c;
+      p[w + 1] = c;
+    }
+  }
+
+  particleStats.drawUs = micros() - start;
+}
+
+
+int particlesBounds(ParticleBox *boxes) {
+  ParticleBox box[PARTICLE_GROUPS];
+  for (int g = 0; g < PARTICLE_GROUPS; g++) {
+    box[g].x0 = box[g].y0 = 0x7FFF;
+    box[g].x1 = box[g].y1 = -0x7FFF;
+  }
+  for (int i = 0; i < count; i++) {
+    ParticleBox &b = box[group[i]];
+    int16_t x = px[i] >> 4, y = py[i] >> 4;
+    b.x0 = min(b.x0, x); b.x1 = max<int16_t>(b.x1, x + size[i]);
+    b.y0 = min(b.y0, y); b.y1 = max<int16_t>(b.y1, y + size[i]);
+  }
+
+  int n = 0;
+  for (int g = 0; g < PARTICLE_GROUPS; g++)
+    if (groupLive[g]) boxes[n++] = box[g];
+  return n;
+}
@@ -0,0 +1,372 @@
+/* Pet behaviour and time-sliced A* pathfinding.
+   The grid holds every position the pet's top-left corner can take, one
+   cell per AI_CELL pixels. Cells where the pet would stand on a poop are
+   not walls but carry a heavy penalty, so the pet walks around mess when
+   it can and still escapes a poop it has just dropped.
+*/
+
+#include "pet_ai.h"
+#include "trace.h"
+
+const int AI_MAX_COLS = 32;
+const int AI_MAX_ROWS = 24;
+const int AI_MAX_CELLS = AI_MAX_COLS * AI_MAX_ROWS;
+
+const uint16_t STEP_COST = 10;      // orthogonal move
+const uint16_t DIAG_COST = 14;      // diagonal move
+const uint8_t  POOP_PENALTY = 20;   // extra steps' worth of cost per cell
+
+PetAiStats petAiStats;
+static uint32_t planUsFrame = 0;        // petAiPlan() totals for the frame
+static uint32_t expansionsFrame = 0;    // being rendered, see petAiFrameDone()
+
+// Grid
+static int cols = 1, rows = 1;
+static int maxX = 0, maxY = 0;
+static int footW = 0, footH = 0;      // pet size, for obstacle overlap
+static uint8_t penalty[AI_MAX_CELLS];
+static uint16_t worldVersion = 0;
+
+// Search state (kept between petAiPlan() calls)
+enum { CELL_NEW = 0, CELL_OPEN = 1, CELL_CLOSED = 2 };
+static uint8_t  cellState[AI_MAX_CELLS];
+static uint16_t gCost[AI_MAX_CELLS];
+static uint16_t fCost[AI_MAX_CELLS];
+static int16_t  parent[AI_MAX_CELLS];
+static int16_t  heapPos[AI_MAX_CELLS];
+static uint16_t heap[AI_MAX_CELLS];
+static int heapSize = 0;
+static bool searching = false;
+static int searchStart = -1, searchGoal = -1;
+
+// Cached result
+static uint16_t path[AI_MAX_CELLS];
+static int pathLen = 0, pathPos = 0;
+static int pathGoal = -1;
+static uint16_t pathVersion = 0xFFFF;
+
+// Behaviour
+static PetBehavior behavior = BEHAVE_WANDER;
+static int goalX = 0, goalY = 0;          // exact pixel goal
+static bool goalReached = true;
+static bool resting = false;
+static unsigned long restSince = 0;
+
+
+static int cellOf(int x, int y) {
+  int cx = constrain((x + AI_CELL / 2) / AI_CELL, 0, cols - 1);
+  int cy = constrain((y + AI_CELL / 2) / AI_CELL, 0, rows - 1);
+  return cy * cols + cx;
+}
+
+
+static uint16_t heuristic(int a, int b) {
+  int dx = abs(a % cols - b % cols);
+  int dy = abs(a / cols - b / cols);
+  int diag = min(dx, dy);
+  return diag * DIAG_COST + (max(dx, dy) - diag) * STEP_COST;   // octile
+}
+
+
+// ---------- binary min-heap on fCost with decrease-key ----------
+static void heapSwap(int i, int j) {
+  uint16_t t = heap[i]; heap[i] = heap[j]; heap[j] = t;
+  heapPos[heap[i]] = i;
+  heapPos[heap[j]] = j;
+}
+
+static void heapUp(int i) {
+  while (i > 0) {
+    int p = (i - 1) >> 1;
+    if (fCost[heap[p]] <= fCost[heap[i]]) break;
+    heapSwap(i, p);
+    i = p;
+  }
+}
+
+static void heapDown(int i) {
+  while (true) {
+    int l = 2 * i + 1, r = l + 1, m = i;
+    if (l < heapSize && fCost[heap[l]] < fCost[heap[m]]) m = l;
+    if (r < heapSize && fCost[heap[r]] < fCost[heap[m]]) m = r;
+    if (m == i) break;
+    heapSwap(i, m);
+    i = m;
+  }
+}
+
+static void heapPush(int c) {
+  heap[heapSize] = c;
+  heapPos[c] = heapSize;
+  heapUp(heapSize++);
+}
+
+static int heapPop() {
+  int c = heap[0];
+  heap[0] = heap[--heapSize];
+  heapPos[heap[0]] = 0;
+  heapDown(0);
+  return c;
+}
+
+
+void petAiInit(int fieldW, int fieldH, int petW, int petH) {
+  maxX = fieldW;
+  maxY = fieldH;
+  footW = petW;
+  footH = petH;
+  cols = min(fieldW / AI_CELL + 1, AI_MAX_COLS);
+  rows = min(fieldH / AI_CELL + 1, AI_MAX_ROWS);
+  petAiClearObstacles();
+  petAiObstaclesDone();
+}
+
+
+void petAiClearObstacles() {
+  memset(penalty, 0, sizeof(penalty));
+}
+
+
+// An obstacle covers every cell where the pet's centre region (middle
+// half of the pet, which stands with its top-left corner on the cell)
+// would overlap it.
+void petAiAddObstacle(int x, int y, int w, int h) {
+  for (int cy = 0; cy < rows; cy++) {
+    int y0 = cy * AI_CELL + footH / 4;
+    int y1 = cy * AI_CELL + footH * 3 / 4;
+    if (y1 <= y || y0 >= y + h) continue;
+    for (int cx = 0; cx < cols; cx++) {
+      int x0 = cx * AI_CELL + footW / 4;
+      int x1 = cx * AI_CELL + footW * 3 / 4;
+      if (x1 <= x || x0 >= x + w) continue;
+      penalty[cy * cols + cx] = POOP_PENALTY;
+    }
+  }
+}
+
+
+void petAiObstaclesDone() {
+  worldVersion++;
+  searching = false;   // any search in flight used the old costs
+}
+
+
+static void startSearch(int from, int to) {
+  memset(cellState, CELL_NEW, cols * rows);
+  heapSize = 0;
+  gCost[from] = 0;
+  fCost[from] = heuristic(from, to);
+  parent[from] = -1;
+  cellState[from] = CELL_OPEN;
+  heapPush(from);
+  searchStart = from;
+  searchGoal = to;
+  searching = true;
+  petAiStats.searchesStarted++;
+}
+
+
+static void finishSearch(bool found) {
+  searching = false;
+  pathLen = pathPos = 0;
+  pathGoal = searchGoal;
+  pathVersion = worldVersion;
+  if (!found) return;
+
+  // Walk parents back from the goal, then reverse in place
+  for (int c = searchGoal; c != -1 && pathLen < AI_MAX_CELLS; c = parent[c])
+    path[pathLen++] = c;
+  for (int i = 0; i < pathLen / 2; i++) {
+    uint16_t t = path[i];
+    path[i] = path[pathLen - 1 - i];
+    path[pathLen - 1 - i] = t;
+  }
+  pathPos = 1;   // path[0] is where we started
+  petAiStats.searchesCompleted++;
+}
+
+
+// Expand one node. Returns false once the search has ended.
+static bool expandOne() {
+  if (heapSize == 0) {
+    finishSearch(false);
+    return false;
+  }
+  int c = heapPop();
+  cellState[c] = CELL_CLOSED;
+  if (c == searchGoal) {
+    finishSearch(true);
+    return false;
+  }
+
+  int cx = c % cols, cy = c / cols;
+  for (int dy = -1; dy <= 1; dy++) {
+    for (int dx = -1; dx <= 1; dx++) {
+      if (!dx && !dy) continue;
+      int nx = cx + dx, ny = cy + dy;
+      if (nx < 0 || ny < 0 || nx >= cols || ny >= rows) continue;
+      int n = ny * cols + nx;
+      if (cellState[n] == CELL_CLOSED) continue;
+
+      uint16_t step = (dx && dy) ? DIAG_COST : STEP_COST;
+      uint16_t g = gCost[c] + step + penalty[n] * STEP_COST;
+      if (cellState[n] == CELL_OPEN && g >= gCost[n]) continue;
+
+      gCost[n] = g;
+      fCost[n] = g + heuristic(n, searchGoal);
+      parent[n] = c;
+      if (cellState[n] == CELL_OPEN) {
+        heapUp(heapPos[n]);
+      } else {
+        cellState[n] = CELL_OPEN;
+        heapPush(n);
+      }
+    }
+  }
+  return true;
+}
+
+
+void petAiPlan(unsigned long budgetUs) {
+  TRACE_SCOPE("petAiPlan");
+  unsigned long start = micros();
+  uint16_t expansions = 0;
+
+  while (searching) {
+    if (!expandOne()) break;
+    expansions++;
+    // micros() is cheap but not free; check it every few expansions
+    if ((expansions & 7) == 0 && micros() - start >= budgetUs) break;
+  }
+
+  planUsFrame += micros() - start;
+  expansionsFrame += expansions;
+}
+
+
+void petAiFrameDone() {
+  petAiStats.planUsLastFrame = planUsFrame;
+  petAiStats.expansionsLastFrame = min<uint32_t>(expansionsFrame, 0xFFFF);
+  if (planUsFrame > petAiStats.planUsMax) petAiStats.planUsMax = planUsFrame;
+  planUsFrame = 0;
+  expansionsFrame = 0;
+}
+
+
+// Ask for a route to the given pixel goal, reusing the cached path when
+// it still leads (nearly) there and the world hasn't changed.
+static void requestPath(int fromX, int fromY, int toX, int toY) {
+  goalX = constrain(toX, 0, maxX);
+  goalY = constrain(toY, 0, maxY);
+  goalReached = false;
+
+  int to = cellOf(goalX, goalY);
+  bool pathFresh = (pathVersion == worldVersion && pathGoal >= 0);
+  if (pathFresh && heuristic(pathGoal, to) <= 2 * STEP_COST) {
+    petAiStats.cacheHits++;
+    return;
+  }
+  if (searching && searchGoal == to) return;
+  pathGoal = -1;
+  startSearch(cellOf(fromX, fromY), to);
+}
+
+
+static int scoreBehavior(PetBehavior b, const PetSenses &s, unsigned long now) {
+  unsigned long restedMs = resting ? now - restSince : 0;
+  int score = 0;
+  switch (b) {
+    case BEHAVE_SEEK_FOOD:  score = s.foodVisible ? 100 : 0; break;
+    case BEHAVE_CHASE_BALL: score = s.ballInPlay ? 90 : 0; break;
+    // a sad pet sits down, but only between strolls
+    case BEHAVE_REST:       score = (s.happiness < 30 && (resting || goalReached)) ? 25 : 0; break;
+    // boredom: the longer the pet rests, the more it wants to walk
+    case BEHAVE_WANDER:     score = 10 + (int)min(restedMs / 200, 30UL); break;
+  }
+  if (b == behavior) score += 5;   // hysteresis
+  return score;
+}
+
+
+PetBehavior petAiThink(const PetSenses &s, unsigned long now) {
+  PetBehavior best = behavior;
+  int bestScore = scoreBehavior(behavior, s, now);
+  for (int b = BEHAVE_WANDER; b <= BEHAVE_CHASE_BALL; b++) {
+    int sc = scoreBehavior((PetBehavior)b, s, now);
+    if (sc > bestScore) {
+      bestScore = sc;
+      best = (PetBehavior)b;
+    }
+  }
+
+  bool changed = (best != behavior);
+  behavior = best;
+
+  switch (behavior) {
+    case BEHAVE_SEEK_FOOD:
+      resting = false;
+      requestPath(s.petX, s.petY, s.foodX, s.foodY);
+      break;
+    case BEHAVE_CHASE_BALL:
+      resting = false;
+      requestPath(s.petX, s.petY, s.ballX, s.ballY);
+      break;
+    case BEHAVE_REST:
+      if (!resting) {
+        resting = true;
+        restSince = now;
+      }
+      break;
+    case BEHAVE_WANDER:
+      if (!changed && !goalReached && !searching && pathVersion != worldVersion) {
+        // poops moved under our feet; replan to the same spot
+        requestPath(s.petX, s.petY, goalX, goalY);
+      } else if (changed || goalReached) {
+        if (goalReached && !changed && s.happiness < 30) {
+          // sad pets sit down again after each stroll
+          resting = true;
+          restSince = now;
+          behavior = BEHAVE_REST;
+          break;
+        }
+        resting = false;
+        requestPath(s.petX, s.petY,
+                    random(0, cols) * AI_CELL, random(0, rows) * AI_CELL);
+      }
+      break;
+  }
+  return behavior;
+}
+
+
+static int approach(int from, int to, int stepPx) {
+  if (to > from) return from + min(stepPx, to - from);
+  return from - min(stepPx, from - to);
+}
+
+
+bool petAiStep(int &x, int &y, int stepPx) {
+  if (behavior == BEHAVE_REST) return true;
+  if (goalReached) return true;
+  if (pathGoal < 0 || pathVersion != worldVersion) return false;
+
+  int tx = goalX, ty = goalY;
+  // Skip waypoints we are already on, then head for the next one.
+  // The last leg goes straight to the exact pixel goal.
+  while (pathPos < pathLen - 1) {
+    int wx = (path[pathPos] % cols) * AI_CELL;
+    int wy = (path[pathPos] / cols) * AI_CELL;
+    if (wx == x && wy == y) {
+      pathPos++;
+      continue;
+    }
+    tx = wx;
+    ty = wy;
+    break;
+  }
+
+  x = approach(x, tx, stepPx);
+  y = approach(y, ty, stepPx);
+  if (x == goalX && y == goalY) goalReached = true;
+  return true;
+}
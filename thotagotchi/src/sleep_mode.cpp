@@ -0,0 +1,73 @@
+/* Deep sleep and wake for the Thotagotchi badge.
+   The ESP32 keeps RTC slow memory and the RTC clock running in deep sleep,
+   so the saved game and the time we went down both survive. On wake the
+   chip boots from scratch; setup() restores the save and the rule engine
+   catches up on the sleep time in one step.
+*/
+
+#include "sleep_mode.h"
+#include "trace.h"
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <sys/time.h>
+
+const uint32_t SAVE_MAGIC = 0x7407C0DE;
+
+RTC_DATA_ATTR SavedGame rtcSave;
+SleepStats sleepStats;
+
+static bool firstFrameSeen = false;
+
+
+static int64_t wallClockUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+static void noopTouchISR() {}
+
+
+bool sleepWokeWithSave() {
+  return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TOUCHPAD &&
+         rtcSave.magic == SAVE_MAGIC;
+}
+
+
+unsigned long sleepElapsedMs() {
+  int64_t us = wallClockUs() - rtcSave.sleptAtUs;
+  sleepStats.sleptMs = (us > 0) ? us / 1000 : 0;
+  return sleepStats.sleptMs;
+}
+
+
+void sleepMarkFirstFrame() {
+  if (firstFrameSeen) return;
+  firstFrameSeen = true;
+  sleepStats.wakeToFirstFrameUs = esp_timer_get_time();
+#ifdef THOT_TRACE
+  Serial.printf("#wake-to-first-frame %lu us (slept %lu ms)\n",
+                (unsigned long)sleepStats.wakeToFirstFrameUs,
+                (unsigned long)sleepStats.sleptMs);
+#endif
+}
+
+
+void sleepEnter(TFT_eSPI &tft, const int *touchPins, const uint16_t *thresholds, int count) {
+  // ST7789 display off, then sleep-in; the controller needs 5 ms after SLPIN
+  tft.writecommand(ST7789_DISPOFF);
+  tft.writecommand(ST7789_SLPIN);
+  delay(5);
+
+  for (int i = 0; i < count; i++)
+    touchAttachInterrupt(touchPins[i], noopTouchISR, thresholds[i]);
+  esp_sleep_enable_touchpad_wakeup();
+
+  rtcSave.magic = SAVE_MAGIC;
+  rtcSave.sleptAtUs = wallClockUs();
+#ifdef THOT_TRACE
+  Serial.flush();
+#endif
+  esp_deep_sleep_start();
+}
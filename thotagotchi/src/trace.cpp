@@ -0,0 +1,59 @@
+/* Trace-event ring buffers for the Thotagotchi badge.
+   One buffer per core, written only by that core, so recording needs
+   no locks. The host sends 'T' and gets the buffers back as text; see
+   tools/trace2chrome.py for the converter to Chrome/Perfetto JSON.
+   Events are stamped with esp_timer_get_time() rather than the cycle
+   counter: the cycle counters are per core and wrap every ~18 s, so they
+   could not be put on one timeline across a sleep or a long blocking
+   screen. It costs a little more per event and has 1 us resolution.
+*/
+
+#include "trace.h"
+#include <esp_timer.h>
+
+#ifdef THOT_TRACE
+
+static TraceEvent traceRing[2][TRACE_EVENTS_PER_CORE];
+static volatile uint32_t traceHead[2] = {0, 0};   // total events written
+
+void traceBegin() {
+  Serial.begin(115200);
+}
+
+
+void IRAM_ATTR traceRecord(const char *name, char phase) {
+  int core = xPortGetCoreID();
+  uint32_t head = traceHead[core];
+  TraceEvent &e = traceRing[core][head & (TRACE_EVENTS_PER_CORE - 1)];
+  e.us = esp_timer_get_time();
+  e.name = name;
+  e.phase = phase;
+  traceHead[core] = head + 1;   // publish only after the slot is filled
+}
+
+
+// Dump format, one event per line:  <core> <phase> <us> <name>
+static void traceDump() {
+  TRACE_SCOPE("traceDump");
+  Serial.println("#trace begin us");
+
+  for (int core = 0; core < 2; core++) {
+    uint32_t head = traceHead[core];
+    uint32_t count = min<uint32_t>(head, TRACE_EVENTS_PER_CORE);
+    for (uint32_t i = head - count; i != head; i++) {
+      const TraceEvent &e = traceRing[core][i & (TRACE_EVENTS_PER_CORE - 1)];
+      Serial.printf("%d %c %llu %s\n", core, e.phase,
+                    (unsigned long long)e.us, e.name);
+    }
+  }
+  Serial.println("#trace end");
+}
+
+
+void traceService() {
+  while (Serial.available()) {
+    if (Serial.read() == 'T') traceDump();
+  }
+}
+
+#endif // THOT_TRACE
@@ -0,0 +1,242 @@
+/* Correctness check and timing for the mask collision (collision.h).
+   Uses the firmware's own masks (pet_masks.h) and checks them against the
+   host display model's drawing, then fuzzes masksOverlap() and
+   masksContact() against a per-pixel brute force and times them against
+   the circle + trig test the ball used before.
+
+   Build (from this directory):
+     g++ -std=c++17 -O2 -I../display_model -I../../include -o collision_bench collision_bench.cpp \
+         ../display_model/display_model.cpp ../../src/collision.cpp -lz
+
+   Usage:
+     ./collision_bench            exits 1 if any check fails
+
+   Timings are host nanoseconds per test, so only the ratios carry over to
+   the badge.
+*/
+
+#include "display_model.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#include "pet_sprites.h"
+#include "draw_bitmap.h"
+#include "pet_masks.h"
+
+const int petWidth = petBitmapWidth * petScale;
+const int petHeight = petBitmapHeight * petScale;
+
+// The firmware tests nothing against poops; this one only widens the fuzz
+constexpr auto poopMaskData = collision::spriteMask<poopW * poopScale, poopH * poopScale>(poop_bitmap_sprite, poopScale);
+constexpr CollisionMask poopMask = poopMaskData.mask();
+
+// Pet position for the timing runs; the ball is sampled around it
+const int petX = 100;
+const int petY = 80;
+
+// The old test: circles of radius petWidth/2 and ballRadius, centre to centre
+const int oldCenterX = petX + petWidth / 2;
+const int oldCenterY = petY + petHeight / 2;
+const int oldReach = petWidth / 2 + ballRadius;
+
+
+static bool maskPixel(const CollisionMask &m, int x, int y) {
+  if (x < 0 || y < 0 || x >= m.width || y >= m.height) return false;
+  return m.rows[y * m.words + (x >> 5)] & (0x80000000u >> (x & 31));
+}
+
+
+// Reference: every pixel of a against b, with the same centroid rounding
+static bool bruteContact(const CollisionMask &a, int ax, int ay,
+                         const CollisionMask &b, int bx, int by,
+                         int &n, long &sumX, long &sumY) {
+  n = 0;
+  sumX = sumY = 0;
+  for (int y = 0; y < a.height; y++)
+    for (int x = 0; x < a.width; x++)
+      if (maskPixel(a, x, y) && maskPixel(b, ax + x - bx, ay + y - by)) {
+        n++;
+        sumX += ax + x;
+        sumY += ay + y;
+      }
+  return n > 0;
+}
+
+
+static bool oldCircleHit(int ballX, int ballY) {
+  int dx = ballX + ballRadius - oldCenterX;
+  int dy = ballY + ballRadius - oldCenterY;
+  return dx * dx + dy * dy < oldReach * oldReach;
+}
+
+
+static int checkFaces() {
+  // Every face must share the happy face's outline, which petMask stands in for
+  constexpr auto sadMaskData = collision::spriteMask<petWidth, petHeight>(pet_sad_sprite, petScale);
+  constexpr auto deadMaskData = collision::spriteMask<petWidth, petHeight>(pet_dead_sprite, petScale);
+  int diff = 0;
+  for (int i = 0; i < petHeight * petMask.words; i++)
+    diff += petMaskData.rows[i] != sadMaskData.rows[i] || petMaskData.rows[i] != deadMaskData.rows[i];
+  printf("face outlines:         %d words differ\n", diff);
+  return diff != 0;
+}
+
+
+static int checkBallMask() {
+  // The mask must cover exactly what drawBall()'s fillCircle() paints
+  St7789Model panel;
+  SpriteModel spr(&panel);
+  const int pad = 5, size = ballDiameter + 1 + 2 * pad;
+  spr.createSprite(size, size);
+  spr.fillSprite(TFT_BLACK);
+  spr.fillCircle(pad + ballRadius, pad + ballRadius, ballRadius, TFT_WHITE);
+  const uint16_t *p = (const uint16_t *)spr.getPointer();
+  int on = 0, bad = 0;
+  for (int y = 0; y < size; y++)
+    for (int x = 0; x < size; x++) {
+      bool drawn = p[y * size + x] != TFT_BLACK;
+      on += drawn;
+      bad += drawn != maskPixel(ballMask, x - pad, y - pad);
+    }
+  printf("ball mask vs drawn:    %d px drawn, %d differ\n", on, bad);
+  return bad != 0;
+}
+
+
+static int checkPetInk() {
+  // No pixel of the drawn pet may fall outside its silhouette
+  St7789Model panel;
+  SpriteModel spr(&panel);
+  spr.createSprite(petWidth, petHeight);
+  spr.fillSprite(TFT_BLACK);
+  drawSprite(spr, pet_happy_sprite, 0, 0, petScale, TFT_WHITE);
+  const uint16_t *p = (const uint16_t *)spr.getPointer();
+  int bad = 0;
+  for (int y = 0; y < petHeight; y++)
+    for (int x = 0; x < petWidth; x++)
+      if (p[y * petWidth + x] != TFT_BLACK && !maskPixel(petMask, x, y)) bad++;
+  printf("pet ink outside mask:  %d px\n", bad);
+  return bad != 0;
+}
+
+
+static int fuzz(int cases) {
+  const CollisionMask *masks[] = {&petMask, &foodMask, &poopMask, &ballMask};
+  srand(1);
+  int hits = 0, bad = 0;
+  for (int t = 0; t < cases; t++) {
+    const CollisionMask &a = *masks[rand() % 4];
+    const CollisionMask &b = *masks[rand() % 4];
+    int ax = rand() % 200 - 60, ay = rand() % 200 - 60;
+    int bx = ax + rand() % 140 - 70, by = ay + rand() % 140 - 70;
+
+    int n;
+    long sumX, sumY;
+    bool expect = bruteContact(a, ax, ay, b, bx, by, n, sumX, sumY);
+    Contact c;
+    bool got = masksContact(a, ax, ay, b, bx, by, c);
+    if (expect != got || expect != masksOverlap(a, ax, ay, b, bx, by)) {
+      bad++;
+      continue;
+    }
+    if (!expect) continue;
+    hits++;
+    if (c.pixels != n || c.x != sumX / n || c.y != sumY / n ||
+        fabsf(c.nx * c.nx + c.ny * c.ny - 1) > 1e-4f)
+      bad++;
+  }
+  printf("fuzz:                  %d cases, %d hits, %d wrong\n", cases, hits, bad);
+  return bad != 0;
+}
+
+
+// ns per test over `reps` passes of the samples. Each loop folds its
+// results into a sum that is printed, so nothing is optimised away.
+template <class F>
+static double timeNs(const std::vector<int> &xs, const std::vector<int> &ys, F test, double &sink) {
+  const int reps = 8;
+  auto start = std::chrono::steady_clock::now();
+  double acc = 0;
+  for (int r = 0; r < reps; r++)
+    for (size_t i = 0; i < xs.size(); i++) acc += test(xs[i], ys[i]);
+  auto end = std::chrono::steady_clock::now();
+  sink += acc;
+  return std::chrono::duration<double, std::nano>(end - start).count() / (reps * xs.size());
+}
+
+
+static void benchCase(const char *name, const std::vector<int> &xs, const std::vector<int> &ys, double &sink) {
+  // The firmware's old response: double atan2 / cos / sin on a circle hit
+  double tOld = timeNs(xs, ys, [](int x, int y) {
+    if (!oldCircleHit(x, y)) return 0.0;
+    double a = atan2((double)(y + ballRadius - oldCenterY), (double)(x + ballRadius - oldCenterX));
+    return cos(a) * 5 + sin(a) * 5;
+  }, sink);
+  double tOverlap = timeNs(xs, ys, [](int x, int y) {
+    return masksOverlap(petMask, petX, petY, ballMask, x, y) ? 1.0 : 0.0;
+  }, sink);
+  double tContact = timeNs(xs, ys, [](int x, int y) {
+    Contact c;
+    if (!masksContact(petMask, petX, petY, ballMask, x, y, c)) return 0.0;
+    return (double)(c.nx * 5 + c.ny * 5);
+  }, sink);
+  printf("%-22s %8zu %12.1f %10.1f %10.1f\n", name, xs.size(), tOld, tOverlap, tContact);
+}
+
+
+static void bench() {
+  const int N = 1 << 20;
+  std::vector<int> allX(N), allY(N);
+  for (int i = 0; i < N; i++) {
+    allX[i] = petX + rand() % 100 - 50;
+    allY[i] = petY + rand() % 100 - 50;
+  }
+
+  // Split the samples by how far the test has to go
+  std::vector<int> farX, farY, nearX, nearY, touchX, touchY;
+  int ghosts = 0, oldHits = 0;
+  for (int i = 0; i < N; i++) {
+    int x = allX[i], y = allY[i];
+    Contact c;
+    bool hit = masksContact(petMask, petX, petY, ballMask, x, y, c);
+    if (!boxesOverlap(petMask, petX, petY, ballMask, x, y)) {
+      farX.push_back(x);
+      farY.push_back(y);
+    } else if (!hit) {
+      nearX.push_back(x);
+      nearY.push_back(y);
+    } else if (c.pixels <= 40) {
+      touchX.push_back(x);
+      touchY.push_back(y);
+    }
+    if (oldCircleHit(x, y)) {
+      oldHits++;
+      if (!hit) ghosts++;
+    }
+  }
+
+  double sink = 0;
+  printf("\nns per test            samples  circle+trig    overlap    contact\n");
+  benchCase("box reject", farX, farY, sink);
+  benchCase("in box, no contact", nearX, nearY, sink);
+  benchCase("first touch (<=40px)", touchX, touchY, sink);
+  benchCase("all samples", allX, allY, sink);
+  printf("\nold circle hits with no pixel contact: %d / %d\n", ghosts, oldHits);
+  printf("(checksum %.0f)\n", sink);
+}
+
+
+int main() {
+  int failed = 0;
+  failed += checkFaces();
+  failed += checkBallMask();
+  failed += checkPetInk();
+  failed += fuzz(200000);
+  bench();
+  if (failed) printf("\n%d check(s) FAILED\n", failed);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,30 @@
+// Host stand-in for <Arduino.h>, so the shared firmware headers
+// (pet_anims.h via anim.h) and src/layers.cpp compile against the
+// display model. Only what those use; no I/O.
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+using std::min;
+using std::max;
+
+inline unsigned long micros() {
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return (unsigned long)duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_byte
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#endif
+
+#endif // HOST_ARDUINO_H
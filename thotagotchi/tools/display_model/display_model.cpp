@@ -0,0 +1,469 @@
+/* Host-side ST7789 / TFT_eSPI model: framebuffers, SPI accounting, PNG I/O.
+   Bus accounting follows TFT_eSPI's ST7789 path: every window is CASET +
+   4 bytes, RASET + 4 bytes, RAMWR, then 2 bytes per pixel; drawPixel()
+   skips CASET/RASET when the column/row window is unchanged.
+*/
+
+#include "display_model.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+// Classic 5x7 GLCD font (TFT_eSPI's LOAD_GLCD), columns LSB-at-top.
+// Only the glyphs the game prints: printable ASCII and the heart.
+static const uint8_t glcdAscii[95][5] = {
+  {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00},  //  !
+  {0x00, 0x07, 0x00, 0x07, 0x00}, {0x14, 0x7F, 0x14, 0x7F, 0x14},  // "#
+  {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},  // $%
+  {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00},  // &'
+  {0x00, 0x1C, 0x22, 0x41, 0x00}, {0x00, 0x41, 0x22, 0x1C, 0x00},  // ()
+  {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},  // *+
+  {0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08},  // ,-
+  {0x00, 0x00, 0x60, 0x60, 0x00}, {0x20, 0x10, 0x08, 0x04, 0x02},  // ./
+  {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},  // 01
+  {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33},  // 23
+  {0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39},  // 45
+  {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},  // 67
+  {0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E},  // 89
+  {0x00, 0x00, 0x14, 0x00, 0x00}, {0x00, 0x40, 0x34, 0x00, 0x00},  // :;
+  {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},  // <=
+  {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06},  // >?
+  {0x3E, 0x41, 0x5D, 0x59, 0x4E}, {0x7C, 0x12, 0x11, 0x12, 0x7C},  // @A
+  {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},  // BC
+  {0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41},  // DE
+  {0x7F, 0x09, 0x09, 0x09, 0x01}, {0x3E, 0x41, 0x41, 0x51, 0x73},  // FG
+  {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},  // HI
+  {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41},  // JK
+  {0x7F, 0x40, 0x40, 0x40, 0x40}, {0x7F, 0x02, 0x1C, 0x02, 0x7F},  // LM
+  {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},  // NO
+  {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E},  // PQ
+  {0x7F, 0x09, 0x19, 0x29, 0x46}, {0x26, 0x49, 0x49, 0x49, 0x32},  // RS
+  {0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F},  // TU
+  {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F},  // VW
+  {0x63, 0x14, 0x08, 0x14, 0x63}, {0x03, 0x04, 0x78, 0x04, 0x03},  // XY
+  {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},  // Z[
+  {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F},  // \]
+  {0x04, 0x02, 0x01, 0x02, 0x04}, {0x40, 0x40, 0x40, 0x40, 0x40},  // ^_
+  {0x00, 0x03, 0x07, 0x08, 0x00}, {0x20, 0x54, 0x54, 0x78, 0x40},  // `a
+  {0x7F, 0x28, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x28},  // bc
+  {0x38, 0x44, 0x44, 0x28, 0x7F}, {0x38, 0x54, 0x54, 0x54, 0x18},  // de
+  {0x00, 0x08, 0x7E, 0x09, 0x02}, {0x18, 0xA4, 0xA4, 0x9C, 0x78},  // fg
+  {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00},  // hi
+  {0x20, 0x40, 0x40, 0x3D, 0x00}, {0x7F, 0x10, 0x28, 0x44, 0x00},  // jk
+  {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x78, 0x04, 0x78},  // lm
+  {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38},  // no
+  {0xFC, 0x18, 0x24, 0x24, 0x18}, {0x18, 0x24, 0x24, 0x18, 0xFC},  // pq
+  {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x24},  // rs
+  {0x04, 0x04, 0x3F, 0x44, 0x24}, {0x3C, 0x40, 0x40, 0x20, 0x7C},  // tu
+  {0x1C, 0x20, 0x40, 0x20, 0x1C}, {0x3C, 0x40, 0x30, 0x40, 0x3C},  // vw
+  {0x44, 0x28, 0x10, 0x28, 0x44}, {0x4C, 0x90, 0x90, 0x90, 0x7C},  // xy
+  {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00},  // z{
+  {0x00, 0x00, 0x77, 0x00, 0x00}, {0x00, 0x41, 0x36, 0x08, 0x00},  // |}
+  {0x02, 0x01, 0x02, 0x04, 0x02},  // ~
+};
+static const uint8_t glcdHeart[5] = {0x1C, 0x3E, 0x7C, 0x3E, 0x1C};
+static const uint8_t glcdBlank[5] = {0, 0, 0, 0, 0};
+
+static const uint8_t *glyphFor(unsigned char c) {
+  if (c >= 0x20 && c < 0x7F) return glcdAscii[c - 0x20];
+  if (c == 0x03) return glcdHeart;
+  return glcdBlank;
+}
+
+
+// ------------------------------ CanvasModel ------------------------------
+
+CanvasModel::CanvasModel(int w, int h, int depth) : w(w), h(h), depth(depth) {
+  resize(depth);
+}
+
+
+void CanvasModel::resize(int newDepth) {
+  depth = newDepth;
+  pixels.assign((size_t)w * h * (depth / 8), 0);
+}
+
+
+uint8_t CanvasModel::color16to8(uint16_t c) {
+  return ((c & 0xE000) >> 8) | ((c & 0x0700) >> 6) | ((c & 0x0018) >> 3);
+}
+
+
+uint16_t CanvasModel::color8to16(uint8_t c) {
+  static const uint8_t blue[] = {0, 11, 21, 31};
+  uint16_t c16 = ((c & 0x1C) << 6) | ((c & 0xC0) << 5) | ((c & 0xE0) << 8);
+  return c16 | ((c & 0x1C) << 3) | blue[c & 0x03];
+}
+
+
+void CanvasModel::plot(int x, int y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= w || y >= h) return;
+  if (depth == 8) {
+    pixels[(size_t)y * w + x] = color16to8(color);
+  } else {
+    size_t i = ((size_t)y * w + x) * 2;
+    pixels[i] = color >> 8;   // big-endian, as sent on the wire
+    pixels[i + 1] = color & 0xFF;
+  }
+}
+
+
+uint16_t CanvasModel::pixel565(int x, int y) const {
+  if (depth == 8) return color8to16(pixels[(size_t)y * w + x]);
+  size_t i = ((size_t)y * w + x) * 2;
+  return (pixels[i] << 8) | pixels[i + 1];
+}
+
+
+void CanvasModel::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  if (x < 0 || y < 0 || x >= w || y >= h) return;
+  beginWrite();
+  busPixel(x, y);
+  plot(x, y, color);
+  endWrite();
+}
+
+
+void CanvasModel::fillRect(int32_t x, int32_t y, int32_t rw, int32_t rh, uint32_t color) {
+  // clip like TFT_eSPI does before touching the bus
+  if (x < 0) { rw += x; x = 0; }
+  if (y < 0) { rh += y; y = 0; }
+  if (x + rw > w) rw = w - x;
+  if (y + rh > h) rh = h - y;
+  if (rw < 1 || rh < 1) return;
+
+  beginWrite();
+  busWindow(x, y, rw, rh);
+  for (int j = y; j < y + rh; j++)
+    for (int i = x; i < x + rw; i++) plot(i, j, color);
+  endWrite();
+}
+
+
+void CanvasModel::drawFastHLine(int32_t x, int32_t y, int32_t len, uint32_t color) {
+  fillRect(x, y, len, 1, color);
+}
+
+
+void CanvasModel::drawFastVLine(int32_t x, int32_t y, int32_t len, uint32_t color) {
+  fillRect(x, y, 1, len, color);
+}
+
+
+void CanvasModel::drawRect(int32_t x, int32_t y, int32_t rw, int32_t rh, uint32_t color) {
+  beginWrite();
+  drawFastHLine(x, y, rw, color);
+  drawFastHLine(x, y + rh - 1, rw, color);
+  drawFastVLine(x, y + 1, rh - 2, color);
+  drawFastVLine(x + rw - 1, y + 1, rh - 2, color);
+  endWrite();
+}
+
+
+// Same scanline walk as TFT_eSPI::fillCircle()
+void CanvasModel::fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  int32_t x = 0, dx = 1, dy = r + r, p = -(r >> 1);
+  beginWrite();
+  drawFastHLine(x0 - r, y0, dy + 1, color);
+  while (x < r) {
+    if (p >= 0) {
+      drawFastHLine(x0 - x, y0 + r, dx, color);
+      drawFastHLine(x0 - x, y0 - r, dx, color);
+      dy -= 2;
+      p -= dy;
+      r--;
+    }
+    dx += 2;
+    p += dx;
+    x++;
+    drawFastHLine(x0 - r, y0 + x, dy + 1, color);
+    drawFastHLine(x0 - r, y0 - x, dy + 1, color);
+  }
+  endWrite();
+}
+
+
+// Midpoint outline; close to, not pixel-identical with, TFT_eSPI's
+void CanvasModel::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  int32_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+  beginWrite();
+  drawPixel(x0, y0 + r, color);
+  drawPixel(x0, y0 - r, color);
+  drawPixel(x0 + r, y0, color);
+  drawPixel(x0 - r, y0, color);
+  while (x < y) {
+    if (f >= 0) { y--; ddy += 2; f += ddy; }
+    x++; ddx += 2; f += ddx;
+    drawPixel(x0 + x, y0 + y, color); drawPixel(x0 - x, y0 + y, color);
+    drawPixel(x0 + x, y0 - y, color); drawPixel(x0 - x, y0 - y, color);
+    drawPixel(x0 + y, y0 + x, color); drawPixel(x0 - y, y0 + x, color);
+    drawPixel(x0 + y, y0 - x, color); drawPixel(x0 - y, y0 - x, color);
+  }
+  endWrite();
+}
+
+
+// TFT_eSPI::drawChar() for the GLCD font: size 1 with a background goes
+// out as one 6x8 window, everything else as a pixel or fillRect per dot.
+void CanvasModel::drawChar(int x, int y, unsigned char c) {
+  const uint8_t *glyph = glyphFor(c);
+  bool fillBg = (textFg != textBg);
+  int s = textSize;
+
+  beginWrite();
+  if (s == 1 && fillBg) {
+    busWindow(x, y, 6, 8);
+    for (int j = 0; j < 8; j++)
+      for (int i = 0; i < 6; i++) {
+        bool on = i < 5 && (glyph[i] >> j) & 1;
+        plot(x + i, y + j, on ? textFg : textBg);
+      }
+  } else {
+    for (int i = 0; i < 6; i++) {
+      uint8_t line = (i < 5) ? glyph[i] : 0;
+      for (int j = 0; j < 8; j++, line >>= 1) {
+        if (line & 1) {
+          if (s == 1) drawPixel(x + i, y + j, textFg);
+          else        fillRect(x + i * s, y + j * s, s, s, textFg);
+        } else if (fillBg) {
+          if (s == 1) drawPixel(x + i, y + j, textBg);
+          else        fillRect(x + i * s, y + j * s, s, s, textBg);
+        }
+      }
+    }
+  }
+  endWrite();
+}
+
+
+size_t CanvasModel::print(char c) {
+  if (c == '\n') {
+    cursorX = 0;
+    cursorY += 8 * textSize;
+    return 1;
+  }
+  if (c == '\r') return 1;
+  if (cursorX + 6 * textSize > w) {   // TFT_eSPI wraps by default
+    cursorX = 0;
+    cursorY += 8 * textSize;
+  }
+  drawChar(cursorX, cursorY, c);
+  cursorX += 6 * textSize;
+  return 1;
+}
+
+
+size_t CanvasModel::print(const char *str) {
+  size_t n = 0;
+  while (*str) n += print(*str++);
+  return n;
+}
+
+
+size_t CanvasModel::print(int value) {
+  char buf[12];
+  snprintf(buf, sizeof(buf), "%d", value);
+  return print(buf);
+}
+
+
+size_t CanvasModel::println(const char *str) {
+  return print(str) + print('\n');
+}
+
+
+size_t CanvasModel::println() {
+  return print('\n');
+}
+
+
+// ------------------------------ St7789Model ------------------------------
+
+void St7789Model::count(uint64_t cmd, uint64_t param, uint64_t pix) {
+  frame.commandBytes += cmd;  total.commandBytes += cmd;
+  frame.paramBytes += param;  total.paramBytes += param;
+  frame.pixelBytes += pix;    total.pixelBytes += pix;
+}
+
+
+void St7789Model::beginWrite() {
+  if (writeDepth++ == 0) {
+    frame.transactions++;
+    total.transactions++;
+  }
+}
+
+
+void St7789Model::endWrite() {
+  writeDepth--;
+}
+
+
+void St7789Model::busWindow(int, int, int rw, int rh) {
+  frame.windows++;
+  total.windows++;
+  lastCol = lastRow = -1;             // a full window update breaks the cache
+  count(3, 8, (uint64_t)rw * rh * 2); // CASET x0,x1  RASET y0,y1  RAMWR  data
+}
+
+
+void St7789Model::busPixel(int x, int y) {
+  frame.windows++;
+  total.windows++;
+  uint64_t cmd = 1, param = 0;        // RAMWR always
+  if (x != lastCol) { cmd++; param += 4; lastCol = x; }
+  if (y != lastRow) { cmd++; param += 4; lastRow = y; }
+  count(cmd, param, 2);
+}
+
+
+void St7789Model::pushBlock(int x, int y, int bw, int bh, const uint16_t *rgb565) {
+  beginWrite();
+  busWindow(x, y, bw, bh);
+  for (int j = 0; j < bh; j++)
+    for (int i = 0; i < bw; i++) plot(x + i, y + j, rgb565[j * bw + i]);
+  endWrite();
+}
+
+
+void St7789Model::beginFrame(const std::string &name) {
+  frameName = name;
+  frame = SpiStats();
+}
+
+
+SpiStats St7789Model::endFrame() {
+  return frame;
+}
+
+
+bool St7789Model::writePNG(const std::string &path) const {
+  std::vector<uint8_t> rgb((size_t)w * h * 3);
+  for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++) {
+      uint16_t c = pixel565(x, y);
+      uint8_t *p = &rgb[((size_t)y * w + x) * 3];
+      p[0] = ((c >> 11) & 0x1F) * 255 / 31;
+      p[1] = ((c >> 5) & 0x3F) * 255 / 63;
+      p[2] = (c & 0x1F) * 255 / 31;
+    }
+  return ::writePNG(path, w, h, rgb);
+}
+
+
+// ------------------------------ SpriteModel ------------------------------
+
+void *SpriteModel::createSprite(int16_t sw, int16_t sh, uint8_t) {
+  w = sw;
+  h = sh;
+  resize(depth);
+  return getPointer();
+}
+
+
+// Like TFT_eSprite, changing depth on a live sprite re-creates it
+void SpriteModel::setColorDepth(int8_t newDepth) {
+  resize(newDepth == 8 ? 8 : 16);
+}
+
+
+void SpriteModel::pushSprite(int32_t x, int32_t y) {
+  std::vector<uint16_t> rgb((size_t)w * h);
+  for (int j = 0; j < h; j++)
+    for (int i = 0; i < w; i++) rgb[(size_t)j * w + i] = pixel565(i, j);
+  panel->pushBlock(x, y, w, h, rgb.data());
+}
+
+
+// ------------------------------ PNG ------------------------------
+
+static void putBE32(std::vector<uint8_t> &out, uint32_t v) {
+  out.push_back(v >> 24); out.push_back(v >> 16);
+  out.push_back(v >> 8);  out.push_back(v);
+}
+
+
+static void putChunk(std::vector<uint8_t> &out, const char *type, const std::vector<uint8_t> &data) {
+  putBE32(out, data.size());
+  size_t start = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  putBE32(out, crc32(0, &out[start], out.size() - start));
+}
+
+
+static uint32_t getBE32(const uint8_t *p) {
+  return (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+
+bool writePNG(const std::string &path, int w, int h, const std::vector<uint8_t> &rgb) {
+  std::vector<uint8_t> raw;   // filter byte 0 + RGB per row
+  raw.reserve((size_t)h * (w * 3 + 1));
+  for (int y = 0; y < h; y++) {
+    raw.push_back(0);
+    raw.insert(raw.end(), &rgb[(size_t)y * w * 3], &rgb[(size_t)(y + 1) * w * 3]);
+  }
+  uLongf zlen = compressBound(raw.size());
+  std::vector<uint8_t> z(zlen);
+  if (compress2(z.data(), &zlen, raw.data(), raw.size(), 9) != Z_OK) return false;
+  z.resize(zlen);
+
+  std::vector<uint8_t> ihdr;
+  putBE32(ihdr, w);
+  putBE32(ihdr, h);
+  const uint8_t rest[] = {8, 2, 0, 0, 0};   // 8-bit RGB, no interlace
+  ihdr.insert(ihdr.end(), rest, rest + 5);
+
+  std::vector<uint8_t> out = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  putChunk(out, "IHDR", ihdr);
+  putChunk(out, "IDAT", z);
+  putChunk(out, "IEND", std::vector<uint8_t>());
+
+  FILE *f = fopen(path.c_str(), "wb");
+  if (!f) return false;
+  bool ok = fwrite(out.data(), 1, out.size(), f) == out.size();
+  return fclose(f) == 0 && ok;
+}
+
+
+bool readPNG(const std::string &path, int &w, int &h, std::vector<uint8_t> &rgb) {
+  FILE *f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  std::vector<uint8_t> in;
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) in.insert(in.end(), buf, buf + n);
+  fclose(f);
+
+  if (in.size() < 8 || memcmp(in.data(), "\x89PNG\r\n\x1a\n", 8) != 0) return false;
+  std::vector<uint8_t> z;
+  w = h = 0;
+  for (size_t pos = 8; pos + 12 <= in.size();) {
+    uint32_t len = getBE32(&in[pos]);
+    const uint8_t *type = &in[pos + 4];
+    const uint8_t *data = &in[pos + 8];
+    if (pos + 12 + len > in.size()) return false;
+    if (!memcmp(type, "IHDR", 4)) {
+      w = getBE32(data);
+      h = getBE32(data + 4);
+      if (data[8] != 8 || data[9] != 2 || data[12] != 0) return false;
+    } else if (!memcmp(type, "IDAT", 4)) {
+      z.insert(z.end(), data, data + len);
+    }
+    pos += 12 + len;
+  }
+  if (w <= 0 || h <= 0) return false;
+
+  std::vector<uint8_t> raw((size_t)h * (w * 3 + 1));
+  uLongf rawLen = raw.size();
+  if (uncompress(raw.data(), &rawLen, z.data(), z.size()) != Z_OK || rawLen != raw.size())
+    return false;
+  rgb.resize((size_t)w * h * 3);
+  for (int y = 0; y < h; y++) {
+    if (raw[(size_t)y * (w * 3 + 1)] != 0) return false;   // we only write filter 0
+    memcpy(&rgb[(size_t)y * w * 3], &raw[(size_t)y * (w * 3 + 1) + 1], w * 3);
+  }
+  return true;
+}
@@ -0,0 +1,160 @@
+// Host-side model of the badge's ST7789 panel and TFT_eSPI sprites.
+// St7789Model and SpriteModel expose the subset of the TFT_eSPI /
+// TFT_eSprite API the game draws with, so templates such as
+// drawScaledBitmap1bpp() compile against them unchanged. Pixels land in
+// in-memory framebuffers; every simulated SPI transfer is accounted the
+// way TFT_eSPI issues it to an ST7789 (CASET/RASET/RAMWR + pixel data).
+#ifndef DISPLAY_MODEL_H
+#define DISPLAY_MODEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// ---- Arduino / TFT_eSPI shims for the shared firmware headers ----
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_byte
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#endif
+
+#define TFT_BLACK       0x0000
+#define TFT_NAVY        0x000F
+#define TFT_PURPLE      0x780F
+#define TFT_DARKGREY    0x7BEF
+#define TFT_LIGHTGREY   0xD69A
+#define TFT_BLUE        0x001F
+#define TFT_GREEN       0x07E0
+#define TFT_CYAN        0x07FF
+#define TFT_RED         0xF800
+#define TFT_MAGENTA     0xF81F
+#define TFT_YELLOW      0xFFE0
+#define TFT_WHITE       0xFFFF
+#define TFT_ORANGE      0xFDA0
+#define TFT_GREENYELLOW 0xB7E0
+#define TFT_PINK        0xFE19
+#define TFT_BROWN       0x9A60
+#define TFT_GOLD        0xFEA0
+
+// SPI traffic, split by what the bytes are for
+struct SpiStats {
+  uint32_t transactions;   // CS low..high
+  uint32_t windows;        // address-window setups
+  uint64_t commandBytes;   // CASET / RASET / RAMWR opcodes (DC low)
+  uint64_t paramBytes;     // window coordinates (DC high)
+  uint64_t pixelBytes;     // RGB565 pixel data (DC high)
+
+  uint64_t totalBytes() const { return commandBytes + paramBytes + pixelBytes; }
+  // Wire time at the given SPI clock plus a fixed cost per transaction
+  double transferUs(uint32_t spiHz, double perTransactionUs = 0.5) const {
+    return totalBytes() * 8.0 * 1e6 / spiHz + transactions * perTransactionUs;
+  }
+};
+
+// Shared drawing core; pixels are RGB565 or RGB332 depending on depth.
+class CanvasModel {
+public:
+  CanvasModel(int w, int h, int depth);
+  virtual ~CanvasModel() {}
+
+  int16_t width() const  { return w; }
+  int16_t height() const { return h; }
+
+  void drawPixel(int32_t x, int32_t y, uint32_t color);
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+  void drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+
+  void setTextSize(uint8_t s) { textSize = s ? s : 1; }
+  void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+  void setTextColor(uint16_t c) { textFg = textBg = c; }
+  void setTextColor(uint16_t fg, uint16_t bg) { textFg = fg; textBg = bg; }
+  size_t print(char c);
+  size_t print(const char *str);
+  size_t print(int n);
+  size_t println(const char *str);
+  size_t println();
+
+  static uint8_t  color16to8(uint16_t c);
+  static uint16_t color8to16(uint8_t c);
+
+  uint16_t pixel565(int x, int y) const;
+
+protected:
+  int w, h, depth;
+  std::vector<uint8_t> pixels;   // w * h * (depth / 8) bytes
+  int16_t cursorX = 0, cursorY = 0;
+  uint8_t textSize = 1;
+  uint16_t textFg = TFT_WHITE, textBg = TFT_WHITE;
+
+  void resize(int depth);
+  void plot(int x, int y, uint16_t color);       // no bus traffic
+  void drawChar(int x, int y, unsigned char c);
+
+  // Bus hooks, only the panel overrides these
+  virtual void beginWrite() {}
+  virtual void endWrite() {}
+  virtual void busWindow(int x, int y, int w, int h) { (void)x; (void)y; (void)w; (void)h; }
+  virtual void busPixel(int x, int y) { (void)x; (void)y; }
+};
+
+// The ST7789 panel on the SPI bus
+class St7789Model : public CanvasModel {
+public:
+  St7789Model(int w = 240, int h = 240) : CanvasModel(w, h, 16) {}
+
+  void init() {}
+  void setRotation(uint8_t) {}
+  void fillScreen(uint32_t color) { fillRect(0, 0, w, h, color); }
+
+  // Account for a block of RGB565 pixels written through one window
+  void pushBlock(int x, int y, int w, int h, const uint16_t *rgb565);
+
+  // Per-frame accounting
+  void beginFrame(const std::string &name);
+  SpiStats endFrame();
+  const SpiStats &totals() const { return total; }
+
+  bool writePNG(const std::string &path) const;
+
+protected:
+  void beginWrite() override;
+  void endWrite() override;
+  void busWindow(int x, int y, int w, int h) override;
+  void busPixel(int x, int y) override;
+
+private:
+  SpiStats frame = {}, total = {};
+  std::string frameName;
+  int writeDepth = 0;
+  int32_t lastCol = -1, lastRow = -1;   // TFT_eSPI's drawPixel window cache
+
+  void count(uint64_t cmd, uint64_t param, uint64_t pix);
+};
+
+// An off-screen TFT_eSprite; only pushSprite() touches the bus
+class SpriteModel : public CanvasModel {
+public:
+  explicit SpriteModel(St7789Model *panel) : CanvasModel(0, 0, 16), panel(panel) {}
+
+  void *createSprite(int16_t w, int16_t h, uint8_t frames = 1);
+  void setColorDepth(int8_t depth);
+  void fillSprite(uint32_t color) { fillRect(0, 0, w, h, color); }
+  void *getPointer() { return pixels.empty() ? nullptr : pixels.data(); }
+  bool created() const { return !pixels.empty(); }
+  void pushSprite(int32_t x, int32_t y);
+
+private:
+  St7789Model *panel;
+};
+
+// Write / read 8-bit RGB PNGs (our own files only on the read side)
+bool writePNG(const std::string &path, int w, int h, const std::vector<uint8_t> &rgb);
+bool readPNG(const std::string &path, int &w, int &h, std::vector<uint8_t> &rgb);
+
+#endif // DISPLAY_MODEL_H
@@ -0,0 +1,190 @@
+/* Frame cost report and golden-image check for the badge display.
+   Replays the game's main screens against the host display model and
+   prints SPI bytes, transactions and estimated transfer time per frame.
+
+   Build (from this directory):
+     g++ -std=c++17 -O2 -I. -I../../include -o frame_report frame_report.cpp display_model.cpp \
+         ../../src/layers.cpp -lz
+
+   Usage:
+     ./frame_report [--spi-hz 40000000] [--out DIR] [--golden DIR [--update]]
+*/
+
+#include "display_model.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The scenes call the firmware's own draw routines and layout
+#include "pet_sprites.h"
+#include "pet_anims.h"
+#include "draw_bitmap.h"
+#include "ui_draw.h"
+#include "layers.h"
+
+typedef void (*SceneFn)(St7789Model &tft, SpriteModel &layer);
+
+
+// First page of showSplashScreen()
+static void sceneSplash(St7789Model &tft, SpriteModel &) {
+  drawSplashPage(tft);
+}
+
+
+// drawHUD() with hunger 20 / happiness 100
+static void sceneHUD(St7789Model &tft, SpriteModel &) {
+  drawHudBar(tft, 20, 100);
+}
+
+
+// drawButtons() with "Feed" selected
+static void sceneButtons(St7789Model &tft, SpriteModel &) {
+  drawMenuButtons(tft, 0);
+}
+
+
+// The dynamic part of drawUI(): pet, food and ball, each marked dirty
+// for the next restore as the firmware does
+static void drawActors(SpriteModel &layer, int petX, int petY, int foodX, int foodY,
+                       int ballX, int ballY, int ballFrame) {
+  drawSprite(layer, pet_happy_sprite, petX, petY, petScale, TFT_WHITE);
+  layersMarkDirty(petX, petY, petBitmapWidth * petScale, petBitmapHeight * petScale);
+  drawSprite(layer, food_bitmap_sprite, foodX, foodY, foodScale, TFT_ORANGE);
+  layersMarkDirty(foodX, foodY, foodW * foodScale, foodH * foodScale);
+  drawBall(layer, ballX, ballY, ballFrame);
+  layersMarkDirty(ballX, ballY, ballDiameter + 1, ballDiameter + 1);
+}
+
+
+// A steady-state play-field frame through the layers path: the poops are
+// in the cached background (renderBackground()), the previous frame left
+// the actors a few pixels away, and this frame restores the dirty rects,
+// redraws the actors and pushes. Stale pixels would show in the golden.
+static void drawField(St7789Model &, SpriteModel &layer, int poopCount) {
+  SpriteModel bg(nullptr);
+  bg.createSprite(spriteW, spriteH);
+  bg.setColorDepth(8);
+  bg.fillSprite(TFT_BLACK);
+  for (int i = 0; i < poopCount; i++)
+    drawSprite(bg, poop_bitmap_sprite, (i % 7) * 33, (i / 7) * 40 + 4,
+               poopScale, TFT_BROWN);
+  layersInit((uint8_t *)bg.getPointer(), (uint8_t *)layer.getPointer(), spriteW, spriteH);
+  layersRestoreAll();
+
+  drawActors(layer, 90, 62, 176, 124, 38, 126, 1);    // previous frame
+
+  layersRestore();
+  drawActors(layer, 96, 66, 180, 120, 30, 130, 2);
+  layer.pushSprite(0, spriteY);
+}
+
+static void sceneFieldEmpty(St7789Model &tft, SpriteModel &layer) { drawField(tft, layer, 0); }
+static void sceneFieldPoops(St7789Model &tft, SpriteModel &layer) { drawField(tft, layer, 25); }
+
+
+// The grave as handleDeath() bakes it into the background
+static void sceneGrave(St7789Model &, SpriteModel &layer) {
+  SpriteModel bg(nullptr);
+  bg.createSprite(spriteW, spriteH);
+  bg.setColorDepth(8);
+  bg.fillSprite(TFT_BLACK);
+  drawSprite(bg, pet_dead_sprite, 96, 66, petScale, TFT_WHITE);
+  drawGraveStone(bg);
+  layersInit((uint8_t *)bg.getPointer(), (uint8_t *)layer.getPointer(), spriteW, spriteH);
+  layersRestoreAll();
+  layer.pushSprite(0, spriteY);
+}
+
+
+struct Scene {
+  const char *name;
+  SceneFn draw;
+};
+
+static const Scene scenes[] = {
+  {"splash",      sceneSplash},
+  {"hud",         sceneHUD},
+  {"buttons",     sceneButtons},
+  {"field-empty", sceneFieldEmpty},
+  {"field-poops", sceneFieldPoops},
+  {"grave",       sceneGrave},
+};
+
+
+// Pixels that differ between the panel and a golden PNG, or -1 if unreadable
+static long compareGolden(const St7789Model &tft, const std::string &path) {
+  int w, h;
+  std::vector<uint8_t> rgb;
+  if (!readPNG(path, w, h, rgb) || w != tft.width() || h != tft.height()) return -1;
+  std::string tmp = path + ".actual.png";
+  tft.writePNG(tmp);
+  int aw, ah;
+  std::vector<uint8_t> actual;
+  readPNG(tmp, aw, ah, actual);
+  long diff = 0;
+  for (size_t i = 0; i < rgb.size(); i += 3)
+    if (memcmp(&rgb[i], &actual[i], 3) != 0) diff++;
+  if (diff == 0) remove(tmp.c_str());
+  return diff;
+}
+
+
+int main(int argc, char **argv) {
+  uint32_t spiHz = 40000000;   // SPI_FREQUENCY from User_Setup.h
+  std::string outDir, goldenDir;
+  bool update = false;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--spi-hz") && i + 1 < argc) spiHz = strtoul(argv[++i], NULL, 0);
+    else if (!strcmp(argv[i], "--out") && i + 1 < argc) outDir = argv[++i];
+    else if (!strcmp(argv[i], "--golden") && i + 1 < argc) goldenDir = argv[++i];
+    else if (!strcmp(argv[i], "--update")) update = true;
+    else {
+      fprintf(stderr, "usage: %s [--spi-hz HZ] [--out DIR] [--golden DIR [--update]]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  printf("SPI clock %.1f MHz\n", spiHz / 1e6);
+  printf("%-12s %6s %7s %6s %7s %9s %9s %9s %10s\n",
+         "frame", "txns", "windows", "cmd", "param", "pixel", "total B", "est ms", "restore px");
+
+  int failures = 0;
+  for (const Scene &s : scenes) {
+    St7789Model tft;
+    SpriteModel layer(&tft);
+    layer.createSprite(spriteW, spriteH);
+    layer.setColorDepth(8);
+
+    layerStats = LayerStats();
+    tft.beginFrame(s.name);
+    s.draw(tft, layer);
+    SpiStats st = tft.endFrame();
+    printf("%-12s %6u %7u %6llu %7llu %9llu %9llu %9.3f %10u\n", s.name,
+           st.transactions, st.windows,
+           (unsigned long long)st.commandBytes, (unsigned long long)st.paramBytes,
+           (unsigned long long)st.pixelBytes, (unsigned long long)st.totalBytes(),
+           st.transferUs(spiHz) / 1000.0, layerStats.restoredPx);
+
+    std::string file = std::string(s.name) + ".png";
+    if (!outDir.empty()) tft.writePNG(outDir + "/" + file);
+    if (!goldenDir.empty()) {
+      std::string golden = goldenDir + "/" + file;
+      if (update) {
+        tft.writePNG(golden);
+      } else {
+        long diff = compareGolden(tft, golden);
+        if (diff != 0) {
+          failures++;
+          if (diff < 0) fprintf(stderr, "  %s: missing or unreadable golden\n", golden.c_str());
+          else fprintf(stderr, "  %s: %ld pixels differ (see %s.actual.png)\n",
+                       golden.c_str(), diff, golden.c_str());
+        }
+      }
+    }
+  }
+
+  if (!goldenDir.empty() && !update)
+    printf("golden check: %s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,315 @@
+#!/usr/bin/env python3
+"""Drive a badge over the binary serial link and collect telemetry.
+
+Needs a firmware built from [env:esp32dev-link]. Runs one of the built-in
+stress scenarios, or a script of one command per line:
+
+    python3 tools/thotlink.py --port /dev/ttyUSB0 poop-storm
+    python3 tools/thotlink.py --port /dev/ttyUSB0 --script rig.txt
+
+Script commands:
+    wheel <deg|off>           touch the wheel at an angle / let go
+    center <0|1>              press / release the center pad
+    tap                       center press for 100 ms
+    action <feed|play|clean>  same as selecting it and tapping center
+    state key=val ...         hunger happiness bad dead dvd poops
+    warp <ms>                 run the game rules forward
+    stream <off|state|frames|both> [period_ms]
+    wait <seconds>            keep reading telemetry
+    ping
+Lines starting with # are ignored.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+SYNC = 0xA5
+MAX_PAYLOAD = 64
+
+PING, WHEEL, CENTER, SET_STATE, WARP, ACTION, STREAM = 0x01, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15
+PONG, ACK, STATE, FRAME = 0x81, 0x82, 0x90, 0x91
+
+FLAG_DEAD, FLAG_DVD, FLAG_EATING, FLAG_PLAYING, FLAG_FOOD = 0x01, 0x02, 0x04, 0x08, 0x10
+STREAM_STATE, STREAM_FRAMES = 0x01, 0x02
+
+ACTIONS = {"feed": 0, "play": 1, "clean": 2}
+
+# must match the packed structs in include/link.h
+STATE_FMT = "<IBBBBBBBBHH"
+FRAME_FMT = "<IIIHHBIHHHH"
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, as linkCrc16() on the badge."""
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def encode(ftype, payload=b""):
+    body = bytes([len(payload), ftype]) + payload
+    crc = crc16(body)
+    return bytes([SYNC]) + body + bytes([crc & 0xFF, crc >> 8])
+
+
+class Decoder:
+    """Byte stream -> (type, payload) frames; counts bad frames."""
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.bad = 0
+
+    def feed(self, data):
+        self.buf += data
+        frames = []
+        while True:
+            start = self.buf.find(bytes([SYNC]))
+            if start < 0:
+                self.buf.clear()
+                return frames
+            del self.buf[:start]
+            if len(self.buf) < 2:
+                return frames
+            n = self.buf[1]
+            if n > MAX_PAYLOAD:
+                self.bad += 1
+                del self.buf[:1]
+                continue
+            if len(self.buf) < n + 5:
+                return frames
+            body = bytes(self.buf[1:n + 3])
+            crc = self.buf[n + 3] | (self.buf[n + 4] << 8)
+            if crc16(body) != crc:
+                self.bad += 1
+                del self.buf[:1]
+                continue
+            frames.append((body[1], body[2:]))
+            del self.buf[:n + 5]
+
+
+class Badge:
+    def __init__(self, port, baud):
+        import serial  # pyserial
+        self.ser = serial.Serial(port, baud, timeout=0)
+        self.ser.reset_input_buffer()
+        self.dec = Decoder()
+        self.state = None
+        self.frames = []       # (frame, simUs, drawUs, restoreUs, particles, quality, misses)
+        self.acks = []
+        self.pongs = 0
+
+    def send(self, ftype, payload=b""):
+        self.ser.write(encode(ftype, payload))
+
+    def poll(self, seconds):
+        end = time.monotonic() + seconds
+        while True:
+            data = self.ser.read(4096)
+            for ftype, p in self.dec.feed(data):
+                self.handle(ftype, p)
+            if time.monotonic() >= end:
+                return
+            if not data:
+                time.sleep(0.002)
+
+    def handle(self, ftype, p):
+        if ftype == STATE and len(p) >= struct.calcsize(STATE_FMT):
+            f = struct.unpack_from(STATE_FMT, p)
+            self.state = dict(zip(("ms", "hunger", "happiness", "bad", "flags", "x", "y",
+                                   "poops", "menu", "rx_bad", "tx_dropped"), f))
+        elif ftype == FRAME and len(p) >= struct.calcsize(FRAME_FMT):
+            self.frames.append(struct.unpack_from(FRAME_FMT, p))
+        elif ftype == ACK and len(p) >= 2:
+            self.acks.append((p[0], p[1]))
+            if not p[1]:
+                print("badge refused command 0x%02x" % p[0])
+        elif ftype == PONG:
+            self.pongs += 1
+
+    # ---- commands ----
+    def ping(self):
+        self.send(PING, b"thot")
+        self.poll(0.2)
+
+    def wheel(self, angle):
+        self.send(WHEEL, struct.pack("<h", -1 if angle is None else angle))
+
+    def center(self, pressed):
+        self.send(CENTER, bytes([1 if pressed else 0]))
+
+    def tap(self):
+        self.center(True)
+        self.poll(0.1)
+        self.center(False)
+
+    def action(self, name):
+        self.send(ACTION, bytes([ACTIONS.get(name, name) if isinstance(name, str) else name]))
+
+    def set_state(self, hunger=20, happiness=100, bad=0, dead=False, dvd=False, poops=0):
+        flags = (FLAG_DEAD if dead else 0) | (FLAG_DVD if dvd else 0)
+        self.send(SET_STATE, struct.pack("<BBBBB", hunger, happiness, bad, flags, poops))
+
+    def warp(self, ms):
+        self.send(WARP, struct.pack("<I", ms))
+
+    def stream(self, mask, period_ms=0):
+        self.send(STREAM, struct.pack("<BH", mask, period_ms))
+
+
+# ---- scenarios ----
+
+def poop_storm(b):
+    """Worst-case field: 25 poops (with stink), then play, timing every frame."""
+    b.set_state(hunger=30, happiness=90, poops=25)
+    b.stream(STREAM_FRAMES)
+    b.poll(5)
+    b.action("play")
+    b.poll(7)
+
+
+def action_spam(b):
+    """Feed / play / clean as fast as the badge accepts them."""
+    b.stream(STREAM_FRAMES | STREAM_STATE, 500)
+    end = time.monotonic() + 20
+    i = 0
+    while time.monotonic() < end:
+        b.action(("feed", "play", "clean")[i % 3])
+        b.poll(0.15)
+        i += 1
+
+
+def wheel_sweep(b):
+    """Drag a finger round the wheel with taps, menu redraws every step."""
+    b.stream(STREAM_FRAMES)
+    for lap in range(5):
+        for angle in range(0, 360, 10):
+            b.wheel(angle)
+            b.poll(0.03)
+            if angle % 90 == 0:
+                b.tap()
+    b.wheel(None)
+    b.poll(0.5)
+
+
+def warp_to_death(b):
+    """Neglect the pet in 5 s warps until it dies; checks the death tick."""
+    b.set_state(hunger=20, happiness=100)
+    b.stream(STREAM_STATE, 0)
+    b.poll(0.3)
+    for i in range(200):
+        b.warp(5000)
+        b.poll(0.05)
+        if b.state and b.state["flags"] & FLAG_DEAD:
+            print("dead after %d warps" % (i + 1))
+            b.set_state()          # revive, so a script can carry on
+            b.poll(0.3)
+            return
+    print("still alive after 200 warps")
+
+
+SCENARIOS = {
+    "poop-storm": poop_storm,
+    "action-spam": action_spam,
+    "wheel-sweep": wheel_sweep,
+    "warp-to-death": warp_to_death,
+}
+
+
+def run_script(b, lines):
+    for n, line in enumerate(lines, 1):
+        words = line.split("#", 1)[0].split()
+        if not words:
+            continue
+        cmd, args = words[0], words[1:]
+        if cmd == "wheel":
+            b.wheel(None if args[0] == "off" else int(args[0]))
+        elif cmd == "center":
+            b.center(args[0] == "1")
+        elif cmd == "tap":
+            b.tap()
+        elif cmd == "action":
+            b.action(args[0] if args[0] in ACTIONS else int(args[0]))
+        elif cmd == "state":
+            kw = {}
+            for a in args:
+                k, v = a.split("=")
+                kw[k] = (v not in ("0", "false")) if k in ("dead", "dvd") else int(v)
+            b.set_state(**kw)
+        elif cmd == "warp":
+            b.warp(int(args[0]))
+        elif cmd == "stream":
+            mask = {"off": 0, "state": STREAM_STATE, "frames": STREAM_FRAMES,
+                    "both": STREAM_STATE | STREAM_FRAMES}[args[0]]
+            b.stream(mask, int(args[1]) if len(args) > 1 else 0)
+        elif cmd == "wait":
+            b.poll(float(args[0]))
+        elif cmd == "ping":
+            b.ping()
+        else:
+            sys.exit("line %d: unknown command %r" % (n, cmd))
+        b.poll(0.01)
+
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+
+def report(b):
+    b.poll(0.3)
+    if b.frames:
+        sim = [f[1] for f in b.frames]
+        draw = [f[2] for f in b.frames]
+        frame = [f[1] + f[2] for f in b.frames]
+        lost = b.frames[-1][0] - b.frames[0][0] + 1 - len(b.frames)
+        print("frames %d (%d not received)" % (len(b.frames), lost))
+        for name, v in (("frame", frame), ("sim", sim), ("draw", draw)):
+            print("%-5s us  avg %d  p95 %d  max %d" % (name, sum(v) / len(v), percentile(v, 95), max(v)))
+        for name, i in (("plan", 7), ("p-upd", 9), ("p-drw", 10)):
+            v = [f[i] for f in b.frames]
+            print("%-5s us  avg %d  p95 %d  max %d" % (name, sum(v) / len(v), percentile(v, 95), max(v)))
+        print("particles max %d" % max(f[4] for f in b.frames))
+        levels = [f[5] for f in b.frames]
+        print("quality levels seen %s, budget misses %d" %
+              (" ".join("L%d:%d" % (l, levels.count(l)) for l in sorted(set(levels))),
+               b.frames[-1][6] - b.frames[0][6]))
+    if b.state:
+        s = b.state
+        print("state: hunger %d happiness %d bad %d flags 0x%02x poops %d" %
+              (s["hunger"], s["happiness"], s["bad"], s["flags"], s["poops"]))
+        print("badge: rx bad %d, tx dropped %d" % (s["rx_bad"], s["tx_dropped"]))
+    print("host: bad frames %d, acks %d" % (b.dec.bad, len(b.acks)))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--port", required=True, help="serial port of the badge")
+    ap.add_argument("--baud", type=int, default=921600)
+    ap.add_argument("--script", help="file of script commands")
+    ap.add_argument("scenario", nargs="?", choices=sorted(SCENARIOS))
+    args = ap.parse_args()
+    if not args.script and not args.scenario:
+        ap.error("give a scenario or --script")
+
+    b = Badge(args.port, args.baud)
+    b.ping()
+    if not b.pongs:
+        sys.exit("no answer from the badge; is it running the esp32dev-link build?")
+
+    if args.script:
+        with open(args.script) as f:
+            run_script(b, f.readlines())
+    else:
+        SCENARIOS[args.scenario](b)
+    b.stream(0)
+    report(b)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Pull the badge trace buffer over serial and write Chrome trace JSON.
+
+Needs a firmware built from [env:esp32dev-trace]. Open the result in
+https://ui.perfetto.dev or chrome://tracing.
+
+    python3 tools/trace2chrome.py --port /dev/ttyUSB0 -o trace.json
+    python3 tools/trace2chrome.py --input dump.txt -o trace.json
+"""
+
+import argparse
+import json
+import sys
+
+
+def read_dump_serial(port, baud, timeout):
+    import serial  # pyserial
+
+    with serial.Serial(port, baud, timeout=timeout) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"T")
+        lines = []
+        started = False
+        while True:
+            raw = ser.readline()
+            if not raw:
+                sys.exit("timed out waiting for trace dump")
+            line = raw.decode("ascii", "replace").strip()
+            if line.startswith("#trace begin"):
+                started = True
+            if started:
+                lines.append(line)
+            if line == "#trace end":
+                return lines
+
+
+def to_chrome(lines):
+    events = []
+    for line in lines:
+        if line.startswith("#trace begin"):
+            # older firmware stamped events with the per-core cycle counter,
+            # which wraps and differs between cores; those dumps can't be
+            # put on one timeline
+            if line.split()[2:] != ["us"]:
+                sys.exit("dump is not in microseconds; reflash the trace build")
+            continue
+        if not line or line.startswith("#"):
+            continue
+        # timestamps are esp_timer microseconds: 64-bit and shared by both
+        # cores, so they sort onto one clock with no wrap handling
+        core, phase, us, name = line.split(" ", 3)
+        events.append({"name": name, "ph": phase, "ts": int(us),
+                       "pid": 0, "tid": int(core)})
+
+    # the ring may start part-way through a scope; drop unmatched ends
+    events.sort(key=lambda e: e["ts"])
+    stacks = {}
+    clean = []
+    for e in events:
+        stack = stacks.setdefault(e["tid"], [])
+        if e["ph"] == "E":
+            if not stack or stack[-1] != e["name"]:
+                continue
+            stack.pop()
+        else:
+            stack.append(e["name"])
+        clean.append(e)
+
+    if clean:
+        t0 = min(e["ts"] for e in clean)
+        for e in clean:
+            e["ts"] = round(e["ts"] - t0, 3)
+    meta = [{"name": "thread_name", "ph": "M", "pid": 0, "tid": c,
+             "args": {"name": "core %d" % c}} for c in sorted(stacks)]
+    return {"traceEvents": meta + clean, "displayTimeUnit": "ms"}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    src = ap.add_mutually_exclusive_group(required=True)
+    src.add_argument("--port", help="serial port of the badge")
+    src.add_argument("--input", help="previously captured dump text")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--timeout", type=float, default=5.0)
+    ap.add_argument("-o", "--output", default="trace.json")
+    args = ap.parse_args()
+
+    if args.port:
+        lines = read_dump_serial(args.port, args.baud, args.timeout)
+    else:
+        with open(args.input) as f:
+            lines = [l.strip() for l in f]
+
+    trace = to_chrome(lines)
+    with open(args.output, "w") as f:
+        json.dump(trace, f)
+    print("wrote %d events to %s" % (len(trace["traceEvents"]), args.output))
+
+
+if __name__ == "__main__":
+    main()